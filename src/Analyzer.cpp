@@ -79,8 +79,8 @@ namespace rvs
 		}
 	}
 
-	Analyzer::Analyzer(std::string const& filepath)
-		: Application(filepath)
+	Analyzer::Analyzer(std::string const& filepath, bool with_opengl)
+		: Application(filepath, "", with_opengl)
 	{}
 
 	void Analyzer::onIntermediateSynthesisResult(int inputFrame, int inputView, int virtualFrame, int virtualView, SynthesizedView const& synthesizedView)
@@ -69,8 +69,9 @@ namespace rvs
 		/**
 		\brief Constructor
 		@param filepath Configuration file (JSON format)
+		@param with_opengl Enable OpenGL acceleration
 		*/
-		Analyzer(std::string const& filepath);
+		Analyzer(std::string const& filepath, bool with_opengl = false);
 
 	protected:
 		void onIntermediateSynthesisResult(int inputFrame, int inputView, int virtualFrame, int virtualView, SynthesizedView const& synthesizedView) override;
@@ -49,8 +49,9 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 namespace rvs
 {
-	Application::Application(std::string const& filepath, std::string const& sourcepath )
-		: m_config(Config::loadFromFile(filepath))
+	Application::Application(std::string const& filepath, std::string const& sourcepath, bool with_opengl)
+		: Pipeline(with_opengl)
+		, m_config(Config::loadFromFile(filepath))
 	{
         
         if( !sourcepath.empty() )
@@ -73,7 +74,7 @@ namespace rvs
 		return std::make_shared<InputView>(
 			getConfig().texture_names[inputView],
 			getConfig().depth_names[inputView],
-			inputFrame, parameters);
+			inputFrame, parameters, getConfig().color_space);
 	}
 
 	bool Application::wantColor()
@@ -103,12 +104,12 @@ namespace rvs
 
 	void Application::saveColor(cv::Mat3f color, int virtualFrame, int virtualView, Parameters const& parameters)
 	{
-		write_color(getConfig().outfilenames[virtualView], color, virtualFrame, parameters);
+		write_color(getConfig().outfilenames[virtualView], color, virtualFrame, parameters, getConfig().color_space);
 	}
 
 	void Application::saveMaskedColor(cv::Mat3f color, int virtualFrame, int virtualView, Parameters const& parameters)
 	{
-		write_color(getConfig().outmaskedfilenames[virtualView], color, virtualFrame, parameters);
+		write_color(getConfig().outmaskedfilenames[virtualView], color, virtualFrame, parameters, getConfig().color_space);
 	}
 
 
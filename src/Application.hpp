@@ -76,8 +76,10 @@ namespace rvs
 		Please note that Application itself also calls getConfig() to allow derived classees overriding the configuration.
 
 		@param filepath Configuration file (JSON format)
+		@param sourcepath Directory that the input file paths are relative to
+		@param with_opengl Enable OpenGL acceleration
 		*/
-		Application(std::string const& filepath, std::string const& sourcepath = "");
+		Application(std::string const& filepath, std::string const& sourcepath = "", bool with_opengl = false);
 
 	protected:
 		Config const& getConfig() const override;
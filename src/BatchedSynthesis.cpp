@@ -0,0 +1,207 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+#include "BatchedSynthesis.hpp"
+#include "RFBO.hpp"
+#include "SpaceTransformer.hpp"
+#include "View.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace rvs
+{
+	namespace opengl
+	{
+		ViewParameters view_parameters(View const& input, SpaceTransformer const& transformer)
+		{
+			auto R = transformer.get_rotation();
+			auto t = transformer.get_translation();
+			auto const& input_parameters = transformer.getInputParameters();
+			auto const& virtual_parameters = transformer.getVirtualParameters();
+
+			ViewParameters parameters = {};
+			for (int j = 0; j < 3; ++j) {
+				for (int i = 0; i < 3; ++i) {
+					parameters.R[j][i] = R(i, j);
+				}
+				parameters.t[j] = t[j];
+			}
+			parameters.w = float(input.get_size().width);
+			parameters.h = float(input.get_size().height);
+			parameters.n_w = float(virtual_parameters.getSize().width);
+			parameters.n_h = float(virtual_parameters.getSize().height);
+			parameters.max_depth = input.get_max_depth();
+			parameters.input_distance = float(cv::max(0.01, cv::norm(t)));
+
+			auto input_projection_type = input_parameters.getProjectionType();
+			auto output_projection_type = virtual_parameters.getProjectionType();
+			parameters.erp_in = input_projection_type == ProjectionType::equirectangular;
+			parameters.erp_out = output_projection_type == ProjectionType::equirectangular;
+
+			if (input_projection_type == ProjectionType::perspective) {
+				auto f = input_parameters.getFocal();
+				auto p = input_parameters.getPrinciplePoint();
+				std::copy(f.val, f.val + 2, parameters.f);
+				std::copy(p.val, p.val + 2, parameters.p);
+			}
+			else if (input_projection_type == ProjectionType::equirectangular) {
+				auto hor_range = input_parameters.getHorRange();
+				auto ver_range = input_parameters.getVerRange();
+				auto constexpr radperdeg = 0.01745329252f;
+				parameters.phi0 = radperdeg * hor_range[1];
+				parameters.theta0 = radperdeg * ver_range[1];
+				parameters.dphi_du = -radperdeg * (hor_range[1] - hor_range[0]) / parameters.w;
+				parameters.dtheta_dv = -radperdeg * (ver_range[1] - ver_range[0]) / parameters.h;
+			}
+			else {
+				throw std::logic_error("Unknown projection type (with OpenGL)");
+			}
+
+			if (output_projection_type == ProjectionType::perspective) {
+				auto n_f = virtual_parameters.getFocal();
+				auto n_p = virtual_parameters.getPrinciplePoint();
+				std::copy(n_f.val, n_f.val + 2, parameters.n_f);
+				std::copy(n_p.val, n_p.val + 2, parameters.n_p);
+			}
+			else if (output_projection_type == ProjectionType::equirectangular) {
+				auto hor_range = virtual_parameters.getHorRange();
+				auto ver_range = virtual_parameters.getVerRange();
+				auto constexpr degperrad = 57.295779513f;
+				parameters.u0 = (hor_range[0] + hor_range[1]) / (hor_range[1] - hor_range[0]);
+				parameters.v0 = -(ver_range[0] + ver_range[1]) / (ver_range[1] - ver_range[0]);
+				parameters.du_dphi = -2.f * degperrad / (hor_range[1] - hor_range[0]);
+				parameters.dv_dtheta = +2.f * degperrad / (ver_range[1] - ver_range[0]);
+			}
+			else {
+				throw std::logic_error("Unknown projection type (with OpenGL)");
+			}
+
+			return parameters;
+		}
+
+		void synthesize_batched(std::vector<std::shared_ptr<View>> const& inputs, std::vector<ViewParameters> const& parameters,
+			Context const& context, float blending_exp)
+		{
+			auto count = static_cast<int>(inputs.size());
+			if (count == 0 || count > BatchedViewParameters::max_views || parameters.size() != inputs.size()) {
+				throw std::logic_error("A batch has 1 to BatchedViewParameters::max_views input views with their parameters");
+			}
+
+			auto FBO = context.fbo.get();
+			auto& resources = *context.gpu_resources;
+			auto& shaders = ShadersList::getInstance();
+
+			// All input views as array textures, and all parameters in one uniform buffer
+			std::vector<cv::Mat> colors;
+			std::vector<cv::Mat> depths;
+			for (auto const& input : inputs) {
+				colors.push_back(input->get_color());
+				depths.push_back(input->get_depth() / input->get_max_depth());
+			}
+			auto image_textures = resources.texture_array(colors, 0);
+			auto depth_textures = resources.texture_array(depths, 1);
+
+			BatchedViewParameters batch = {};
+			std::copy(parameters.begin(), parameters.end(), batch.views);
+			resources.uniform_buffer(BatchedViewParameters::binding, &batch, sizeof(batch));
+
+			// Warp: one instance per input view, into the layer of the same index
+			FBO->init_layers(count);
+			auto const& synthesis = shaders("synthesis_layered");
+			assert(synthesis.getProgramID() != 0);
+
+			glEnable(GL_DEPTH_TEST);
+			glBindFramebuffer(GL_FRAMEBUFFER, FBO->layered_ID);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			glUseProgram(synthesis.getProgramID());
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, image_textures);
+			glUniform1i(synthesis.uniform("image_textures"), 0);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, depth_textures);
+			glUniform1i(synthesis.uniform("depth_textures"), 1);
+
+			auto const& mesh = resources.mesh(inputs.front()->get_size());
+			glBindVertexArray(mesh.VAO);
+			glDrawElementsInstanced(GL_TRIANGLES, GLsizei(mesh.number_of_elements), GL_UNSIGNED_INT, nullptr, count);
+			glBindVertexArray(0);
+			glDisable(GL_DEPTH_TEST);
+
+			// Resolve: blend all layers into the blending result
+			auto const& blending = shaders("blending_layered");
+			assert(blending.getProgramID() != 0);
+
+			glBindFramebuffer(GL_FRAMEBUFFER, FBO->ID);
+			GLenum result_attachments[] = { GLenum(GL_COLOR_ATTACHMENT3 + 2 * FBO->value), GLenum(GL_COLOR_ATTACHMENT4 + 2 * FBO->value) };
+			glDrawBuffers(2, result_attachments);
+
+			glUseProgram(blending.getProgramID());
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, FBO->layered_image);
+			glUniform1i(blending.uniform("layered_image"), 0);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, FBO->layered_depth);
+			glUniform1i(blending.uniform("layered_depth"), 1);
+			glActiveTexture(GL_TEXTURE2);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, FBO->layered_quality);
+			glUniform1i(blending.uniform("layered_quality"), 2);
+			glUniform1i(blending.uniform("number_of_views"), count);
+			glUniform1f(blending.uniform("blending_factor"), blending_exp);
+
+			glBindVertexArray(resources.quad());
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+			glBindVertexArray(0);
+			glUseProgram(0);
+
+			GLuint attachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 ,GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5, GL_COLOR_ATTACHMENT6 };
+			glDrawBuffers(7, attachments);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		}
+	}
+}
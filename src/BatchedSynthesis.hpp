@@ -0,0 +1,93 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+#ifndef _BATCHED_SYNTHESIS_HPP_
+#define _BATCHED_SYNTHESIS_HPP_
+
+#if !WITH_OPENGL
+#error "This header requires WITH_OPENGL"
+#endif
+
+#include "Context.hpp"
+#include "Shader.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace rvs
+{
+	class View;
+	class SpaceTransformer;
+
+	namespace opengl
+	{
+		/**
+		\brief Parameters of the synthesis programs to warp an input view to the virtual view
+
+		@param input Input view
+		@param transformer Space transformer with the input and virtual camera parameters of the input view
+		*/
+		ViewParameters view_parameters(View const& input, SpaceTransformer const& transformer);
+
+		/**
+		\brief Warp and blend all input views of a virtual view on the GPU, with one draw and one resolve pass
+
+		The input views are uploaded as array textures, and warped with one instanced draw into the layers of a layered
+		framebuffer (see RFBO::init_layers()), one layer per view. One full-screen pass then blends all layers with the weights of
+		BlendedViewSimple, into the blending result of the frame buffer object, as after the last BlendedViewSimple::blend().
+
+		The input views should have depth maps (no polynomial depth) of the same size, and use the full triangulation.
+		@param inputs Input views, at most BatchedViewParameters::max_views
+		@param parameters Parameters per input view (see view_parameters())
+		@param context Context of the pipeline, with an initialized frame buffer object
+		@param blending_exp Blending exponent (see BlendedViewSimple)
+		*/
+		void synthesize_batched(std::vector<std::shared_ptr<View>> const& inputs, std::vector<ViewParameters> const& parameters,
+			Context const& context, float blending_exp);
+	}
+}
+
+#endif
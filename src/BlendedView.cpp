@@ -48,6 +48,7 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "blending.hpp"
 
 #include "iostream"
+#include <stdexcept>
 
 #if WITH_OPENGL
 #include "helpersGL.hpp"
@@ -58,6 +59,16 @@ namespace rvs
 {
 	BlendedView::~BlendedView() {}
 
+	void BlendedView::setContext(Context const& context)
+	{
+		m_context = context;
+	}
+
+	Context const& BlendedView::getContext() const
+	{
+		return m_context;
+	}
+
 	BlendedViewMultiSpec::BlendedViewMultiSpec(float exp_low_freq, float exp_high_freq)
 		: m_low_freq(exp_low_freq)
 		, m_high_freq(exp_high_freq)
@@ -71,7 +82,7 @@ namespace rvs
 		cv::Mat3f low_color;
 		cv::Mat3f high_color;
 		auto mask = cv::Mat1b(view.get_quality() > 0.f);
-		detail::split_frequencies(view.get_color(), low_color, high_color, mask);
+		detail::split_frequencies(view.get_color(), low_color, high_color, mask, getContext().color_space, m_blur);
 
 		// Repack as views
 		auto low_view = View(low_color, view.get_depth(), view.get_quality(), view.get_validity());
@@ -85,6 +96,13 @@ namespace rvs
 		assign(m_low_freq.get_color() + m_high_freq.get_color(), m_low_freq.get_depth(), m_low_freq.get_quality(), m_low_freq.get_validity());
 	}
 
+	void BlendedViewMultiSpec::setContext(Context const& context)
+	{
+		BlendedView::setContext(context);
+		m_low_freq.setContext(context);
+		m_high_freq.setContext(context);
+	}
+
 	BlendedViewSimple::BlendedViewSimple(float blending_exp)
 		: m_is_empty(true)
 		, m_blending_exp(blending_exp)
@@ -99,34 +117,13 @@ namespace rvs
 	void BlendedViewSimple::blend(View const& view)
 	{
 #if WITH_OPENGL
-		if (g_with_opengl) {
-			auto FBO = opengl::RFBO::getInstance();
+		if (getContext().with_opengl) {
+			auto FBO = getContext().fbo.get();
 			auto & shaders = opengl::ShadersList::getInstance();
-			// QUAD VAO
-			GLfloat quadVertices[] = {
-				-1.0f, 1.0f, 0.0f, 1.0f,
-				-1.0f, -1.0f, 0.0f, 0.0f,
-				1.0f, -1.0f, 1.0f, 0.0f,
-				-1.0f, 1.0f, 0.0f, 1.0f,
-				1.0f, -1.0f, 1.0f, 0.0f,
-				1.0f, 1.0f, 1.0f, 1.0f };
-			GLuint quadVAO, quadVBO;
-			glGenVertexArrays(1, &quadVAO);
-			glGenBuffers(1, &quadVBO);
-			glBindVertexArray(quadVAO);
-			glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
-			glEnableVertexAttribArray(0);
-			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE,
-				4 * sizeof(GLfloat), (GLvoid*)0);
-			glEnableVertexAttribArray(1);
-			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE,
-				4 * sizeof(GLfloat), (GLvoid*)(2 * sizeof(GLfloat)));
-			glBindVertexArray(0);
-			// END QUAD VAO
+			auto quadVAO = getContext().gpu_resources->quad();
 
-			GLuint program = shaders("blending2").getProgramID();
-			if (FBO->value) program = shaders("blending1").getProgramID();
+			auto const& shader = FBO->value ? shaders("blending1") : shaders("blending2");
+			GLuint program = shader.getProgramID();
 
 			assert(program != 0);
 
@@ -138,25 +135,25 @@ namespace rvs
 
 			glActiveTexture(GL_TEXTURE0);
 			glBindTexture(GL_TEXTURE_2D, FBO->image);
-			glUniform1i(glGetUniformLocation(program, "new_image"), 0);
+			glUniform1i(shader.uniform("new_image"), 0);
 			glActiveTexture(GL_TEXTURE1);
 			glBindTexture(GL_TEXTURE_2D, FBO->depth);
-			glUniform1i(glGetUniformLocation(program, "new_depth"), 1);
+			glUniform1i(shader.uniform("new_depth"), 1);
 			glActiveTexture(GL_TEXTURE2);
 			glBindTexture(GL_TEXTURE_2D, FBO->quality_triangle);
-			glUniform1i(glGetUniformLocation(program, "new_triangle_quality"), 2);
+			glUniform1i(shader.uniform("new_triangle_quality"), 2);
 
 			glActiveTexture(GL_TEXTURE3 + 2 * FBO->value);
 			glBindTexture(GL_TEXTURE_2D, FBO->swap_image[FBO->value]);
-			glUniform1i(glGetUniformLocation(program, "accumulator_image"), 3 + 2 * FBO->value);
+			glUniform1i(shader.uniform("accumulator_image"), 3 + 2 * FBO->value);
 
 			glActiveTexture(GL_TEXTURE4 + 2 * FBO->value);
 			glBindTexture(GL_TEXTURE_2D, FBO->swap_quality[FBO->value]);
-			glUniform1i(glGetUniformLocation(program, "accumulator_quality"), 4 + 2 * FBO->value);
+			glUniform1i(shader.uniform("accumulator_quality"), 4 + 2 * FBO->value);
 
 			// parameters
-			glUniform1f(glGetUniformLocation(program, "blending_factor"), m_blending_exp);
-			glUniform1f(glGetUniformLocation(program, "input_distance"), view.distance_from_origin);
+			glUniform1f(shader.uniform("blending_factor"), m_blending_exp);
+			glUniform1f(shader.uniform("input_distance"), view.distance_from_origin);
 			// end parameters
 
 			glBindVertexArray(quadVAO);
@@ -168,7 +165,19 @@ namespace rvs
 			FBO->toggle();
 		}
 #endif
-		if (!g_with_opengl) {
+		if (!getContext().with_opengl && getContext().packed_views && m_blending_exp >= 0.f) {
+			// Packed accumulator: one pass over interleaved pixels per view
+			if (m_is_empty) {
+				m_is_empty = false;
+				assign_packed(detail::pack_view(view.get_color(), view.get_depth(), view.get_quality(), view.get_validity(), view.get_depth_mask()));
+			}
+			else {
+				auto packed = get_packed();
+				detail::blend_packed(packed, view.get_color(), view.get_depth(), view.get_quality(), view.get_validity(), empty_rgb_color, m_blending_exp);
+				assign_packed(packed);
+			}
+		}
+		else if (!getContext().with_opengl) {
 			if (m_is_empty) {
 				m_is_empty = false;
 				assign(view.get_color(), view.get_depth(), view.get_quality(), view.get_validity());
@@ -200,38 +209,55 @@ namespace rvs
 		}
 	}
 
-#if WITH_OPENGL
-	void BlendedView::assignFromGL2CV(cv::Size size)
+	BlendedViewLaplacian::BlendedViewLaplacian(float blending_exp)
+		: m_blending_exp(blending_exp)
 	{
-		auto FBO = opengl::RFBO::getInstance();
-		cv::Mat3f img(size, CV_32FC3);
-
-		glPixelStorei(GL_PACK_ALIGNMENT, 4);
-		glPixelStorei(GL_PACK_ROW_LENGTH, GLint(img.step / img.elemSize()));
-
-		glBindFramebuffer(GL_FRAMEBUFFER, FBO->ID);
-		glReadBuffer(GL_COLOR_ATTACHMENT3 + 2 * FBO->value);
-		glReadPixels(0, 0, img.cols, img.rows, GL_BGR, GL_FLOAT, img.ptr());
-
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-		cv::flip(img, img, 0);
+		assign(cv::Mat3f(), cv::Mat1f(), cv::Mat1f(), cv::Mat1f());
+	}
 
-		cv::Mat validity = cv::Mat::ones(size, CV_32FC1);
+	BlendedViewLaplacian::~BlendedViewLaplacian() {}
 
-		glPixelStorei(GL_PACK_ALIGNMENT, 4);
-		glPixelStorei(GL_PACK_ROW_LENGTH, GLint(validity.step / validity.elemSize()));
+	void BlendedViewLaplacian::blend(View const& view)
+	{
+		if (getContext().with_opengl) {
+			throw std::logic_error("Laplacian blending is not available with OpenGL");
+		}
 
-		glBindFramebuffer(GL_FRAMEBUFFER, FBO->ID);
-		glReadBuffer(GL_COLOR_ATTACHMENT4 + 2 * (FBO->value));
-		glReadPixels(0, 0, validity.cols, validity.rows, GL_RED, GL_FLOAT, validity.ptr());
+		// Blending weights: quality^blending_exp, 0 without quality
+		cv::Mat1f weight;
+		cv::pow(cv::max(view.get_quality(), 0.f), m_blending_exp, weight);
+		weight.setTo(0.f, ~(view.get_quality() > 0.f));
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		auto first = m_bands.empty();
+		auto levels = detail::laplacian_pyramid_levels(view.get_size());
+		detail::accumulate_laplacian_pyramid(view.get_color(), weight, levels, m_bands, m_weights);
+		auto color = detail::collapse_laplacian_pyramid(m_bands, m_weights, empty_rgb_color);
 
-		cv::flip(validity, validity, 0);
+		if (first) {
+			assign(color, view.get_depth(), view.get_quality(), view.get_validity());
+		}
+		else {
+			auto depth = get_depth().clone();
+			view.get_depth().copyTo(depth, view.get_quality() > get_quality());
+			assign(color, depth, max(get_quality(), view.get_quality()), max(get_validity(), view.get_validity()));
+		}
+	}
 
-		assign(img, cv::Mat1f(), validity, validity);
+#if WITH_OPENGL
+	void BlendedView::requestOutputFromGL(cv::Size output_size, float validity_threshold)
+	{
+		auto FBO = getContext().fbo.get();
+		m_readback_slot = FBO->request_output(output_size, validity_threshold);
 		FBO->clear_buffers();
 	}
+
+	void BlendedView::assignOutputFromGL2CV(cv::Size output_size, cv::Mat3f& color, cv::Mat1b& mask)
+	{
+		if (m_readback_slot < 0) {
+			throw std::logic_error("The output frame was not requested (see requestOutputFromGL())");
+		}
+		getContext().fbo->map_output(m_readback_slot, output_size, color, mask);
+		m_readback_slot = -1;
+	}
 #endif
 }
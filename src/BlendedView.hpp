@@ -49,6 +49,7 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 #include "SynthesizedView.hpp"
 #include "View.hpp"
+#include "blending.hpp"
 
 #include <opencv2/core.hpp>
 
@@ -83,11 +84,36 @@ namespace rvs
 		\brief Blends this view with a new view.
 		*/
 		virtual void blend(View const& view) = 0;
+
+		/**
+		\brief Set the context of the pipeline (color space, OpenGL)
+		*/
+		virtual void setContext(Context const& context);
 #if WITH_OPENGL
 		/**
-		\brief Transfert textures from OpenGL to OpenCV Matrices (color, validity)
+		\brief Start the asynchronous transfer of the final output frame from OpenGL (see RFBO::request_output())
+
+		The blending result is inpainted, downscaled and masked on the GPU, and the frame buffer objects can be reused for the
+		next view immediately.
 		*/
-		void assignFromGL2CV(cv::Size size);
+		void requestOutputFromGL(cv::Size output_size, float validity_threshold);
+
+		/**
+		\brief Complete the transfer started by requestOutputFromGL(): inpainted color and validity mask at the output size
+		*/
+		void assignOutputFromGL2CV(cv::Size output_size, cv::Mat3f& color, cv::Mat1b& mask);
+#endif
+
+	protected:
+		/**
+		\brief Context of the pipeline
+		*/
+		Context const& getContext() const;
+
+	private:
+		Context m_context;
+#if WITH_OPENGL
+		int m_readback_slot = -1;
 #endif
 	};
 
@@ -173,9 +199,52 @@ namespace rvs
 		*/
 		void blend(View const& view);
 
+		/**
+		\brief Set the context of the pipeline, also for the low and high frequency blenders
+		*/
+		void setContext(Context const& context);
+
 	private:
 		BlendedViewSimple m_low_freq;
 		BlendedViewSimple m_high_freq;
+		detail::MaskedBoxBlur m_blur;
+	};
+
+	/**
+	\brief Multi-band blending with Laplacian pyramids
+
+	Each view is decomposed in a Laplacian pyramid (see detail::accumulate_laplacian_pyramid()), and each band is blended with
+	the Gaussian pyramid of the weights \f$w_i=q_i^\alpha\f$ as in BlendedViewSimple. Coarse bands are thus blended over large
+	regions and fine bands over small regions. The blended bands are kept per level, and collapsed to the color image after
+	each view. Without OpenGL.
+	*/
+	class BlendedViewLaplacian : public BlendedView {
+	public:
+		/**
+		\brief Initialise an empty blending
+		@param blending_exp Blending factor \f$\alpha\f$ (> 0)
+		*/
+		BlendedViewLaplacian(float blending_exp);
+
+		/**
+		\brief Destructor
+		*/
+		~BlendedViewLaplacian();
+
+		/**
+		\brief Adds a new view to the blended image.
+
+		The quality of the result is the maximum of the qualities, and the depth is that of the view with the highest quality.
+		@param view View to add to the blended image.
+		*/
+		void blend(View const& view);
+
+	private:
+		float m_blending_exp;
+
+		// Weighted sums of the bands and sums of the weights per level
+		std::vector<cv::Mat3f> m_bands;
+		std::vector<cv::Mat1f> m_weights;
 	};
 }
 
@@ -47,6 +47,7 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "Config.hpp"
 #include "JsonParser.hpp"
 
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -57,17 +58,6 @@ namespace rvs
 {
 	bool g_verbose = false;
 
-	namespace detail
-	{
-		float const defaultPrecision = 1.f;
-		ColorSpace const defaultColorSpace = ColorSpace::YUV;
-
-		float g_rescale = defaultPrecision;
-		ColorSpace g_color_space = defaultColorSpace;
-	}
-
-	bool g_with_opengl = true;
-
 	Config Config::loadFromFile(std::string const& filename)
 	{
 		if(g_verbose)
@@ -96,6 +86,9 @@ namespace rvs
 		config.setOutputFilepaths(root, "MaskedDepthOutputFiles", config.outmaskdepthfilenames);
 		config.setValidityThreshold(root);
 		config.setSynthesisMethod(root);
+		config.setSplatSize(root);
+		config.setMeshDecimation(root);
+		config.setOcclusionOrder(root);
 		config.setBlendingMethod(root);
 		config.setBlendingFactor(root);
 		config.setBlendingLowFreqFactor(root);
@@ -103,9 +96,15 @@ namespace rvs
 		config.setStartFrame(root);
 		config.setNumberOfFrames(root);
 		config.setNumberOfOutputFrames(root);
+		config.setInputViewCulling(root);
+		config.setMaxInputViews(root);
+		config.setParallelVirtualViews(root);
 
-		setPrecision(root);
-		setColorSpace(root);
+		config.setPrecision(root);
+		config.setTiledOversampling(root);
+		config.setBatchedRendering(root);
+		config.setPackedViews(root);
+		config.setColorSpace(root);
 
 		auto node = root.optional("VirtualPoseTraceName");
 		if (node) {
@@ -118,6 +117,27 @@ namespace rvs
 		return config;
 	}
 
+	Config Config::create(std::vector<std::string> const& inputCameraNames, std::vector<Parameters> const& inputParameters,
+		std::vector<std::string> const& virtualCameraNames, std::vector<Parameters> const& virtualParameters)
+	{
+		if (inputCameraNames.size() != inputParameters.size()) {
+			throw std::runtime_error("Number of input camera parameters should match with the input camera names");
+		}
+		if (virtualCameraNames.size() != virtualParameters.size()) {
+			throw std::runtime_error("Number of virtual camera parameters should match with the virtual camera names");
+		}
+		if (inputCameraNames.empty() || virtualCameraNames.empty()) {
+			throw std::runtime_error("At least one input and one virtual camera are required");
+		}
+
+		Config config;
+		config.InputCameraNames = inputCameraNames;
+		config.params_real = inputParameters;
+		config.VirtualCameraNames = virtualCameraNames;
+		config.params_virtual = virtualParameters;
+		return config;
+	}
+
 	std::vector<Parameters> Config::loadCamerasParametersFromFile(std::string const& filepath, std::vector<std::string> names, json::Node overrides)
 	{
 		// Load the camera parameters
@@ -316,6 +336,42 @@ namespace rvs
 		}
 	}
 
+	void Config::setSplatSize(json::Node root)
+	{
+		auto node = root.optional("SplatSize");
+		if (node) {
+			splat_size = static_cast<float>(node.asDouble());
+			if (splat_size < 0.f) {
+				throw std::runtime_error("SplatSize should be non-negative");
+			}
+			if (g_verbose)
+				std::cout << "SplatSize: " << splat_size << '\n';
+		}
+	}
+
+	void Config::setMeshDecimation(json::Node root)
+	{
+		auto node = root.optional("MeshDecimation");
+		if (node) {
+			mesh_decimation = static_cast<float>(node.asDouble());
+			if (mesh_decimation < 0.f) {
+				throw std::runtime_error("MeshDecimation should be non-negative");
+			}
+			if (g_verbose)
+				std::cout << "MeshDecimation: " << mesh_decimation << '\n';
+		}
+	}
+
+	void Config::setOcclusionOrder(json::Node root)
+	{
+		auto node = root.optional("OcclusionOrder");
+		if (node) {
+			occlusion_order = node.asBool();
+			if (g_verbose)
+				std::cout << "OcclusionOrder: " << std::boolalpha << occlusion_order << '\n';
+		}
+	}
+
 	void Config::setBlendingMethod(json::Node root)
 	{
 		auto node = root.optional("BlendingMethod");
@@ -385,16 +441,79 @@ namespace rvs
 			number_of_output_frames = number_of_frames;
 	}
 
+	void Config::setInputViewCulling(json::Node root)
+	{
+		auto node = root.optional("InputViewCulling");
+		if (node) {
+			input_view_culling = node.asBool();
+			if (g_verbose)
+				std::cout << "InputViewCulling: " << std::boolalpha << input_view_culling << '\n';
+		}
+	}
+
+	void Config::setMaxInputViews(json::Node root)
+	{
+		auto node = root.optional("MaxInputViews");
+		if (node) {
+			max_input_views = node.asInt();
+			if (max_input_views < 0) {
+				throw std::runtime_error("MaxInputViews should be non-negative");
+			}
+			if (g_verbose)
+				std::cout << "MaxInputViews: " << max_input_views << '\n';
+		}
+	}
+
+	void Config::setParallelVirtualViews(json::Node root)
+	{
+		auto node = root.optional("ParallelVirtualViews");
+		if (node) {
+			parallel_virtual_views = node.asBool();
+			if (g_verbose)
+				std::cout << "ParallelVirtualViews: " << std::boolalpha << parallel_virtual_views << '\n';
+		}
+	}
+
 	void Config::setPrecision(json::Node root)
 	{
 		auto node = root.optional("Precision");
 		if (node) {
-			detail::g_rescale = static_cast<float>(node.asDouble());
+			precision = static_cast<float>(node.asDouble());
+			if (g_verbose)
+				std::cout << "Precision: " << precision << '\n';
+		}
+	}
+
+	void Config::setTiledOversampling(json::Node root)
+	{
+		auto node = root.optional("TiledOversampling");
+		if (node) {
+			tiled_oversampling = node.asBool();
+			if (tiled_oversampling && (precision < 1.f || precision != std::floor(precision))) {
+				throw std::runtime_error("TiledOversampling requires an integer Precision");
+			}
+			if (g_verbose)
+				std::cout << "TiledOversampling: " << std::boolalpha << tiled_oversampling << '\n';
+		}
+	}
+
+	void Config::setBatchedRendering(json::Node root)
+	{
+		auto node = root.optional("BatchedRendering");
+		if (node) {
+			batched_rendering = node.asBool();
 			if (g_verbose)
-				std::cout << "Precision: " << detail::g_rescale << '\n';
+				std::cout << "BatchedRendering: " << std::boolalpha << batched_rendering << '\n';
 		}
-		else {
-			detail::g_rescale = detail::defaultPrecision;
+	}
+
+	void Config::setPackedViews(json::Node root)
+	{
+		auto node = root.optional("PackedViews");
+		if (node) {
+			packed_views = node.asBool();
+			if (g_verbose)
+				std::cout << "PackedViews: " << std::boolalpha << packed_views << '\n';
 		}
 	}
 
@@ -403,12 +522,12 @@ namespace rvs
 		auto node = root.optional("ColorSpace");
 		if (node) {
 			if (node.asString() == "YUV") {
-				detail::g_color_space = detail::ColorSpace::YUV;
+				color_space = detail::ColorSpace::YUV;
 				if (g_verbose)
 					std::cout << "ColorSpace: YUV\n";
 			}
 			else if (node.asString() == "RGB") {
-				detail::g_color_space = detail::ColorSpace::RGB;
+				color_space = detail::ColorSpace::RGB;
 				if (g_verbose)
 					std::cout << "ColorSpace: RGB\n";
 			}
@@ -416,8 +535,5 @@ namespace rvs
 				throw std::runtime_error("Unknown color space");
 			}
 		}
-		else {
-			detail::g_color_space = detail::defaultColorSpace;
-		}
 	}
 }
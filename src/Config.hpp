@@ -47,6 +47,7 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #ifndef _CONFIG_HPP_
 #define _CONFIG_HPP_
 
+#include "Context.hpp"
 #include "Parameters.hpp"
 #include "PoseTraces.hpp"
 #include "JsonParser.hpp"
@@ -63,25 +64,15 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 namespace rvs
 {
-	namespace detail
-	{
-		/**\brief Working color space
-
-		Doesn't need to be the same as the input our output color space
-		*/
-		enum class ColorSpace {
-			YUV = 0,
-			RGB = 1
-		};
-	}
-
 	/**\brief View synthesis method
 
-	For now only the triangle method is available
+	\see SynthetisedViewTriangle, SynthetisedViewBackwardWarp, SynthetisedViewSplat
 	*/
 	namespace ViewSynthesisMethod
 	{
 		auto const triangles = "Triangles";
+		auto const backward_warp = "BackwardWarp";
+		auto const splat = "Splat";
 	}
 
 	/**\brief Blending method
@@ -92,20 +83,9 @@ namespace rvs
 	{
 		auto const simple = "Simple";
 		auto const multispectral = "Multispectral";
+		auto const laplacian = "Laplacian";
 	}
 
-	namespace detail
-	{
-		/**Precision*/
-		extern float g_rescale;
-
-		/**Working color space (RGB or YUV). Independent of the input or output formats*/
-		extern ColorSpace g_color_space;
-	}
-
-	/** Enable OpenGL acceleration */
-	extern bool g_with_opengl;
-
 	/**
 	\brief Configuration parameters
 	*/
@@ -114,6 +94,13 @@ namespace rvs
 		/** Load configuration from file */
 		static Config loadFromFile(std::string const& filename);
 
+		/** Create a configuration from camera parameters in memory (see Parameters::readFrom())
+
+		All other settings have their default values and can be changed afterwards. There are no input or output filenames.
+		*/
+		static Config create(std::vector<std::string> const& inputCameraNames, std::vector<Parameters> const& inputParameters,
+			std::vector<std::string> const& virtualCameraNames, std::vector<Parameters> const& virtualParameters);
+
 		/** Version of the configuration file */
 		std::string version;
 
@@ -156,14 +143,23 @@ namespace rvs
 		/** Method for view synthesis */
 		std::string vs_method = "Triangles";
 
+		/** Width of a splat in virtual view pixels for the Splat method (0 for the distance between warped neighbours) */
+		float splat_size = 0.f;
+
+		/** Relative depth tolerance of the adaptive triangulation of the input depth maps (0 to triangulate all pixels) */
+		float mesh_decimation = 0.f;
+
+		/** Rasterize the triangles of perspective input views nearest first, in occlusion-compatible order */
+		bool occlusion_order = false;
+
 		/** Blending method (see BlendedView) */
 		std::string blending_method = "Simple";
 
 		/** Low frequency blending factor in BlendedViewMultiSpec */
-		float blending_low_freq_factor;
+		float blending_low_freq_factor = 1.f;
 
 		/** High frequency blending factor in BlendedViewMultiSpec */
-		float blending_high_freq_factor;
+		float blending_high_freq_factor = 4.f;
 
 		/** Blending factor in BlendedViewSimple */
 		float blending_factor = 5.f;
@@ -178,6 +174,30 @@ namespace rvs
 		/** The loaded pose trace */
 		PoseTrace pose_trace;
 
+		/** Skip input views that cannot contribute to a virtual view (conservative frustum test) */
+		bool input_view_culling = false;
+
+		/** Maximum number of input views per virtual view, nearest first (0 means no limit) */
+		int max_input_views = 0;
+
+		/** Compute the virtual views of a frame in parallel (CPU only) */
+		bool parallel_virtual_views = false;
+
+		/** Precision: oversampling factor of the rasterization */
+		float precision = 1.f;
+
+		/** Oversample only inside the rasterizer, tile by tile, and blend at the resolution of the virtual view */
+		bool tiled_oversampling = false;
+
+		/** Warp all input views of a virtual view in one layered draw and blend them in one pass (OpenGL only) */
+		bool batched_rendering = false;
+
+		/** Blend in the packed pixel layout: one interleaved array instead of separate maps (CPU only) */
+		bool packed_views = false;
+
+		/** Working color space (RGB or YUV). Independent of the input or output formats */
+		detail::ColorSpace color_space = detail::ColorSpace::YUV;
+
 	private:
 		Config() = default;
 
@@ -193,6 +213,9 @@ namespace rvs
 		void setOutputFilepaths(json::Node root, char const *name, std::vector<std::string>&);
 		void setValidityThreshold(json::Node root);
 		void setSynthesisMethod(json::Node root);
+		void setSplatSize(json::Node root);
+		void setMeshDecimation(json::Node root);
+		void setOcclusionOrder(json::Node root);
 		void setBlendingMethod(json::Node root);
 		void setBlendingFactor(json::Node root);
 		void setBlendingLowFreqFactor(json::Node root);
@@ -200,9 +223,15 @@ namespace rvs
 		void setStartFrame(json::Node root);
 		void setNumberOfFrames(json::Node root);
 		void setNumberOfOutputFrames(json::Node root);
-
-		static void setPrecision(json::Node root);
-		static void setColorSpace(json::Node root);
+		void setInputViewCulling(json::Node root);
+		void setMaxInputViews(json::Node root);
+		void setParallelVirtualViews(json::Node root);
+
+		void setPrecision(json::Node root);
+		void setTiledOversampling(json::Node root);
+		void setBatchedRendering(json::Node root);
+		void setPackedViews(json::Node root);
+		void setColorSpace(json::Node root);
 	};
 }
 
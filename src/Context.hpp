@@ -0,0 +1,108 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+#ifndef _CONTEXT_HPP_
+#define _CONTEXT_HPP_
+
+#include <memory>
+
+/**
+@file Context.hpp
+\brief The file containing the per-pipeline state
+*/
+
+namespace rvs
+{
+	namespace detail
+	{
+		/**\brief Working color space
+
+		Doesn't need to be the same as the input our output color space
+		*/
+		enum class ColorSpace {
+			YUV = 0,
+			RGB = 1
+		};
+	}
+
+	namespace opengl
+	{
+		class RFBO;
+		class ResourceCache;
+	}
+
+	/**
+	\brief State shared by the stages of one pipeline
+
+	Each Pipeline owns a context and hands a copy to its view synthesizers and blenders. There is no process-wide state,
+	such that independent pipelines (e.g. with a different Precision) can run concurrently in one process.
+	*/
+	struct Context
+	{
+		/** Precision: oversampling factor of the rasterization */
+		float rescale = 1.f;
+
+		/** Oversample only inside the rasterizer: the synthesized views are resolved to the virtual view resolution */
+		bool tiled_oversampling = false;
+
+		/** Blend in the packed pixel layout (see detail::PackedPixel), with Simple blending without OpenGL */
+		bool packed_views = false;
+
+		/** Working color space (RGB or YUV). Independent of the input or output formats */
+		detail::ColorSpace color_space = detail::ColorSpace::YUV;
+
+		/** Enable OpenGL acceleration */
+		bool with_opengl = false;
+
+		/** Frame buffer objects of the pipeline (OpenGL only) */
+		std::shared_ptr<opengl::RFBO> fbo;
+
+		/** Meshes and textures kept across views and frames (OpenGL only) */
+		std::shared_ptr<opengl::ResourceCache> gpu_resources;
+	};
+}
+
+#endif
@@ -0,0 +1,186 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+#include "EmbeddedPipeline.hpp"
+
+#include <limits>
+#include <sstream>
+
+namespace rvs
+{
+	namespace
+	{
+		// Input view that refers to caller-owned buffers
+		class BufferView : public View
+		{
+		public:
+			BufferView(InputBuffers const& buffers, Parameters const& parameters)
+				: m_parameters(parameters)
+			{
+				auto size = parameters.getSize();
+				auto color = cv::Mat3f(size, const_cast<float*>(buffers.color), buffers.color_step ? buffers.color_step : cv::Mat::AUTO_STEP);
+				auto depth = cv::Mat1f(size, const_cast<float*>(buffers.depth), buffers.depth_step ? buffers.depth_step : cv::Mat::AUTO_STEP);
+				assign(color, depth, cv::Mat1f(), cv::Mat1f());
+			}
+
+			float get_max_depth() const override { return m_parameters.getDepthRange()[1]; }
+			float get_min_depth() const override { return m_parameters.getDepthRange()[0]; }
+
+		private:
+			Parameters const m_parameters;
+		};
+	}
+
+	EmbeddedPipeline::EmbeddedPipeline(Config const& config, bool with_opengl)
+		: Pipeline(with_opengl)
+		, m_config(config)
+	{}
+
+	void EmbeddedPipeline::setInput(InputCallback callback)
+	{
+		m_input = callback;
+	}
+
+	void EmbeddedPipeline::onColor(ColorCallback callback)
+	{
+		m_color = callback;
+	}
+
+	void EmbeddedPipeline::onMaskedColor(ColorCallback callback)
+	{
+		m_masked_color = callback;
+	}
+
+	void EmbeddedPipeline::onMask(MaskCallback callback)
+	{
+		m_mask = callback;
+	}
+
+	void EmbeddedPipeline::onDepth(DepthCallback callback)
+	{
+		m_depth = callback;
+	}
+
+	void EmbeddedPipeline::onMaskedDepth(DepthCallback callback)
+	{
+		m_masked_depth = callback;
+	}
+
+	Config const& EmbeddedPipeline::getConfig() const
+	{
+		return m_config;
+	}
+
+	std::shared_ptr<View> EmbeddedPipeline::loadInputView(int inputFrame, int inputView, Parameters const& parameters)
+	{
+		if (!m_input) {
+			throw std::logic_error("EmbeddedPipeline has no input (see EmbeddedPipeline::setInput)");
+		}
+		if (parameters.getDisplacementMethod() != DisplacementMethod::depth) {
+			throw std::runtime_error("EmbeddedPipeline only supports input views with a depth map");
+		}
+		auto buffers = m_input(inputFrame, inputView);
+		if (!buffers.color || !buffers.depth) {
+			std::ostringstream what;
+			what << "No buffers for frame " << inputFrame << " of input view " << getConfig().InputCameraNames[inputView];
+			throw std::runtime_error(what.str());
+		}
+		return std::make_shared<BufferView>(buffers, parameters);
+	}
+
+	bool EmbeddedPipeline::wantColor()
+	{
+		return !!m_color;
+	}
+
+	bool EmbeddedPipeline::wantMaskedColor()
+	{
+		return !!m_masked_color;
+	}
+
+	bool EmbeddedPipeline::wantMask()
+	{
+		return !!m_mask;
+	}
+
+	bool EmbeddedPipeline::wantDepth()
+	{
+		return !!m_depth;
+	}
+
+	bool EmbeddedPipeline::wantMaskedDepth()
+	{
+		return !!m_masked_depth;
+	}
+
+	void EmbeddedPipeline::saveColor(cv::Mat3f color, int virtualFrame, int virtualView, Parameters const&)
+	{
+		m_color(virtualFrame, virtualView, color);
+	}
+
+	void EmbeddedPipeline::saveMaskedColor(cv::Mat3f color, int virtualFrame, int virtualView, Parameters const&)
+	{
+		m_masked_color(virtualFrame, virtualView, color);
+	}
+
+	void EmbeddedPipeline::saveMask(cv::Mat1b mask, int virtualFrame, int virtualView, Parameters const&)
+	{
+		m_mask(virtualFrame, virtualView, mask);
+	}
+
+	void EmbeddedPipeline::saveDepth(cv::Mat1f depth, int virtualFrame, int virtualView, Parameters const&)
+	{
+		m_depth(virtualFrame, virtualView, depth);
+	}
+
+	void EmbeddedPipeline::saveMaskedDepth(cv::Mat1f depth, cv::Mat1b mask, int virtualFrame, int virtualView, Parameters const&)
+	{
+		// In memory, invalid depth is NaN (see InputBuffers); clone to avoid modifying the depth of the blended view
+		depth = depth.clone();
+		depth.setTo(std::numeric_limits<float>::quiet_NaN(), mask);
+		m_masked_depth(virtualFrame, virtualView, depth);
+	}
+}
@@ -0,0 +1,161 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+#ifndef _EMBEDDED_PIPELINE_HPP_
+#define _EMBEDDED_PIPELINE_HPP_
+
+#include "Pipeline.hpp"
+
+#include <functional>
+
+/**
+@file EmbeddedPipeline.hpp
+\brief The file containing the in-memory pipeline to embed RVS in another application
+*/
+
+namespace rvs
+{
+	/**
+	\brief Caller-owned buffers of one input view
+
+	The buffers are wrapped without copying, and have to stay valid and unchanged until EmbeddedPipeline::execute() returns.
+	The resolution is that of the camera parameters (Parameters::getSize()), without padding.
+	*/
+	struct InputBuffers
+	{
+		/** Color: three interleaved floats per pixel in the working color space (Config::color_space), normalized to [0, 1] */
+		float const *color = nullptr;
+
+		/** Bytes from one row of color to the next (0 when the rows are contiguous) */
+		std::size_t color_step = 0;
+
+		/** Depth: one float per pixel in scene units (not normalized), NaN for invalid depth */
+		float const *depth = nullptr;
+
+		/** Bytes from one row of depth to the next (0 when the rows are contiguous) */
+		std::size_t depth_step = 0;
+	};
+
+	/**
+	\brief The RVS pipeline without file input or output
+
+	The configuration is built in memory (see Config::create()), input views are provided by the caller as buffers
+	(see InputBuffers) and the synthesized views are returned through callbacks. Only the outputs with a callback are computed.
+
+	The matrices passed to the callbacks refer to memory of the pipeline and are only valid during the call. With
+	ParallelVirtualViews the callbacks of different virtual views may be called concurrently.
+
+	Only depth maps are supported (no polynomial displacement).
+	*/
+	class EmbeddedPipeline : public Pipeline
+	{
+	public:
+		/** Provide the buffers of an input view: (inputFrame, inputView) */
+		using InputCallback = std::function<InputBuffers(int, int)>;
+
+		/** Receive a synthesized color image in the working color space: (virtualFrame, virtualView, color) */
+		using ColorCallback = std::function<void(int, int, cv::Mat3f const&)>;
+
+		/** Receive a validity mask, 255 for pixels that are masked out: (virtualFrame, virtualView, mask) */
+		using MaskCallback = std::function<void(int, int, cv::Mat1b const&)>;
+
+		/** Receive a synthesized depth map: (virtualFrame, virtualView, depth) */
+		using DepthCallback = std::function<void(int, int, cv::Mat1f const&)>;
+
+		/**
+		\brief Constructor
+		@param config Configuration (see Config::create())
+		@param with_opengl Enable OpenGL acceleration
+		*/
+		EmbeddedPipeline(Config const& config, bool with_opengl = false);
+
+		/** Set the callback that provides the input views (required) */
+		void setInput(InputCallback callback);
+
+		/** Set the callback that receives the inpainted color images */
+		void onColor(ColorCallback callback);
+
+		/** Set the callback that receives the color images with invalid pixels masked out */
+		void onMaskedColor(ColorCallback callback);
+
+		/** Set the callback that receives the validity masks */
+		void onMask(MaskCallback callback);
+
+		/** Set the callback that receives the depth maps */
+		void onDepth(DepthCallback callback);
+
+		/** Set the callback that receives the depth maps with invalid pixels masked out */
+		void onMaskedDepth(DepthCallback callback);
+
+	protected:
+		Config const& getConfig() const override;
+
+		std::shared_ptr<View> loadInputView(int inputFrame, int inputView, Parameters const& parameters) override;
+
+		bool wantColor() override;
+		bool wantMaskedColor() override;
+		bool wantMask() override;
+		bool wantDepth() override;
+		bool wantMaskedDepth() override;
+
+		void saveColor(cv::Mat3f color, int virtualFrame, int virtualView, Parameters const& parameters) override;
+		void saveMaskedColor(cv::Mat3f color, int virtualFrame, int virtualView, Parameters const& parameters) override;
+		void saveMask(cv::Mat1b mask, int virtualFrame, int virtualView, Parameters const& parameters) override;
+		void saveDepth(cv::Mat1f depth, int virtualFrame, int virtualView, Parameters const& parameters) override;
+		void saveMaskedDepth(cv::Mat1f depth, cv::Mat1b mask, int virtualFrame, int virtualView, Parameters const& parameters) override;
+
+	private:
+		Config m_config;
+		InputCallback m_input;
+		ColorCallback m_color;
+		ColorCallback m_masked_color;
+		MaskCallback m_mask;
+		DepthCallback m_depth;
+		DepthCallback m_masked_depth;
+	};
+}
+
+#endif
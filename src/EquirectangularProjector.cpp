@@ -54,37 +54,29 @@ namespace rvs
 		: Projector(parameters)
 	{}
 
+	EquirectangularProjector::Kernel::Kernel(Parameters const& parameters)
+	{
+		auto size = parameters.getSize();
+		auto hor_range = parameters.getHorRange();
+		auto ver_range = parameters.getVerRange();
+
+		auto const degperrad = 57.295779513f;
+		u0 = size.width * hor_range[1] / (hor_range[1] - hor_range[0]);
+		v0 = size.height * ver_range[1] / (ver_range[1] - ver_range[0]);
+		du_dphi = -degperrad * size.width  / (hor_range[1] - hor_range[0]);
+		dv_dtheta = -degperrad * size.height / (ver_range[1] - ver_range[0]);
+	}
+
 	cv::Mat2f EquirectangularProjector::project(cv::Mat3f world_pos, /*out*/ cv::Mat1f& depth, /*out*/ WrappingMethod& wrapping_method) const
 	{
-		depth = cv::Mat1f(world_pos.size());
+		Kernel kernel(getParameters());
 
+		depth = cv::Mat1f(world_pos.size());
 		auto image_pos = cv::Mat2f(world_pos.size());
-		auto size = getParameters().getSize();
-		auto hor_range = getParameters().getHorRange();
-		auto ver_range = getParameters().getVerRange();
-
-		auto const degperrad = 57.295779513f;
-		auto u0 = size.width * hor_range[1] / (hor_range[1] - hor_range[0]);
-		auto v0 = size.height * ver_range[1] / (ver_range[1] - ver_range[0]);
-		auto du_dphi = -degperrad * size.width  / (hor_range[1] - hor_range[0]);
-		auto dv_dtheta = -degperrad * size.height / (ver_range[1] - ver_range[0]);
 
 		for (int i = 0; i != world_pos.rows; ++i) {
 			for (int j = 0; j != world_pos.cols; ++j) {
-				auto xyz = world_pos(i, j);
-
-				// Radius is depth
-				auto radius = static_cast<float>(cv::norm(xyz));
-				depth(i, j) = radius;
-
-				// Spherical coordinates
-				auto phi = std::atan2(xyz[1], xyz[0]);
-				auto theta = std::asin(xyz[2] / radius);
-
-				// Image coordinates
-				image_pos(i, j) = cv::Vec2f(
-					u0 + du_dphi * phi,
-					v0 + dv_dtheta * theta);
+				image_pos(i, j) = kernel(world_pos(i, j), depth(i, j));
 			}
 		}
 
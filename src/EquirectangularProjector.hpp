@@ -52,6 +52,8 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "Projector.hpp"
 #include "Config.hpp"
 
+#include <cmath>
+
 namespace rvs
 {
 	/**\brief EquirectangularProjector*/
@@ -75,6 +77,33 @@ namespace rvs
 		@return Map of the pixels in image coordinates
 		*/
 		cv::Mat2f project(cv::Mat3f world_pos, /*out*/ cv::Mat1f& depth, /*out*/ WrappingMethod& wrapping_method) const override;
+
+		/**\brief Projection of a single point, inlined in the warp kernels (see GenericTransformer::warp())*/
+		struct Kernel
+		{
+			explicit Kernel(Parameters const& parameters);
+
+			cv::Vec2f operator()(cv::Vec3f xyz, /*out*/ float& depth) const
+			{
+				// Radius is depth
+				auto radius = std::sqrt(xyz.dot(xyz));
+				depth = radius;
+
+				// Spherical coordinates
+				auto phi = std::atan2(xyz[1], xyz[0]);
+				auto theta = std::asin(xyz[2] / radius);
+
+				// Image coordinates
+				return cv::Vec2f(
+					u0 + du_dphi * phi,
+					v0 + dv_dtheta * theta);
+			}
+
+			float u0;
+			float v0;
+			float du_dphi;
+			float dv_dtheta;
+		};
 	};
 }
 
@@ -50,32 +50,28 @@ namespace rvs
 		: Unprojector(parameters)
 	{}
 
-	cv::Mat3f EquirectangularUnprojector::unproject(cv::Mat2f image_pos, cv::Mat1f depth) const
+	EquirectangularUnprojector::Kernel::Kernel(Parameters const& parameters)
 	{
-		auto world_pos = cv::Mat3f(image_pos.size());
-		auto size = getParameters().getSize();
-		auto hor_range = getParameters().getHorRange();
-		auto ver_range = getParameters().getVerRange();
+		auto size = parameters.getSize();
+		auto hor_range = parameters.getHorRange();
+		auto ver_range = parameters.getVerRange();
 
 		auto const radperdeg = 0.01745329252f;
-		auto phi0 = radperdeg * hor_range[1];
-		auto theta0 = radperdeg * ver_range[1];
-		auto dphi_du = -radperdeg * (hor_range[1] - hor_range[0]) / size.width;
-		auto dtheta_dv = -radperdeg * (ver_range[1] - ver_range[0]) / size.height;
+		phi0 = radperdeg * hor_range[1];
+		theta0 = radperdeg * ver_range[1];
+		dphi_du = -radperdeg * (hor_range[1] - hor_range[0]) / size.width;
+		dtheta_dv = -radperdeg * (ver_range[1] - ver_range[0]) / size.height;
+	}
 
-		for (int i = 0; i != image_pos.rows; ++i) {
-			for (int j = 0; j != image_pos.cols; ++j) {
-				auto uv = image_pos(i, j);
+	cv::Mat3f EquirectangularUnprojector::unproject(cv::Mat2f image_pos, cv::Mat1f depth) const
+	{
+		Kernel kernel(getParameters());
 
-				// Spherical coordinates
-				auto phi = phi0 + dphi_du * uv[0];
-				auto theta = theta0 + dtheta_dv * uv[1];
+		auto world_pos = cv::Mat3f(image_pos.size());
 
-				// World position
-				world_pos(i, j) = depth(i, j) * cv::Vec3f(
-					std::cos(theta) * std::cos(phi),
-					std::cos(theta) * std::sin(phi),
-					std::sin(theta));
+		for (int i = 0; i != image_pos.rows; ++i) {
+			for (int j = 0; j != image_pos.cols; ++j) {
+				world_pos(i, j) = kernel(image_pos(i, j), depth(i, j));
 			}
 		}
 
@@ -48,6 +48,8 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "Unprojector.hpp"
 #include "Config.hpp"
 
+#include <cmath>
+
 /**
 @file EquirectangularUnprojector.hpp
 */
@@ -77,6 +79,30 @@ namespace rvs
 
 		/** Override to adjust rendering of poles */
 		cv::Mat2f generateImagePos() const override;
+
+		/**\brief Unprojection of a single point, inlined in the warp kernels (see GenericTransformer::warp())*/
+		struct Kernel
+		{
+			explicit Kernel(Parameters const& parameters);
+
+			cv::Vec3f operator()(cv::Vec2f uv, float depth) const
+			{
+				// Spherical coordinates
+				auto phi = phi0 + dphi_du * uv[0];
+				auto theta = theta0 + dtheta_dv * uv[1];
+
+				// World position
+				return depth * cv::Vec3f(
+					std::cos(theta) * std::cos(phi),
+					std::cos(theta) * std::sin(phi),
+					std::sin(theta));
+			}
+
+			float phi0;
+			float theta0;
+			float dphi_du;
+			float dtheta_dv;
+		};
 	};
 }
 
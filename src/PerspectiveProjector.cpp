@@ -56,29 +56,21 @@ namespace rvs
 		: Projector(parameters)
 	{}
 
+	PerspectiveProjector::Kernel::Kernel(Parameters const& parameters)
+		: f(parameters.getFocal())
+		, p(parameters.getPrinciplePoint())
+	{}
+
 	cv::Mat2f PerspectiveProjector::project(cv::Mat3f world_pos, /*out*/ cv::Mat1f& depth, /*out*/ WrappingMethod& wrapping_method) const
 	{
-		auto f = getParameters().getFocal();
-		auto p = getParameters().getPrinciplePoint();
+		Kernel kernel(getParameters());
 
 		cv::Mat2f image_pos(world_pos.size(), cv::Vec2f::all(NaN));
 		depth = cv::Mat1f(world_pos.size(), NaN);
 
 		for (int i = 0; i != world_pos.rows; ++i) {
 			for (int j = 0; j != world_pos.cols; ++j) {
-				auto xyz = world_pos(i, j);
-
-				// OMAF Referential: x forward, y left, z up
-				// Image plane: x right, y down
-
-				if (xyz[0] > 0.f) {
-					auto uv = cv::Vec2f(
-						-f[0] * xyz[1] / xyz[0] + p[0],
-						-f[1] * xyz[2] / xyz[0] + p[1]);
-
-					image_pos(i, j) = uv;
-					depth(i, j) = xyz[0];
-				}
+				image_pos(i, j) = kernel(world_pos(i, j), depth(i, j));
 			}
 		}
 
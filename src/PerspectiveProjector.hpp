@@ -52,6 +52,8 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "Projector.hpp"
 #include "Config.hpp"
 
+#include <limits>
+
 namespace rvs
 {
 	/**\brief PerspectiveProjector*/
@@ -75,6 +77,29 @@ namespace rvs
 		@return Map of the pixels in image coordinates
 		*/
 		cv::Mat2f project(cv::Mat3f world_pos, /*out*/ cv::Mat1f& depth, /*out*/ WrappingMethod& wrapping_method) const override;
+
+		/**\brief Projection of a single point, inlined in the warp kernels (see GenericTransformer::warp())*/
+		struct Kernel
+		{
+			explicit Kernel(Parameters const& parameters);
+
+			cv::Vec2f operator()(cv::Vec3f xyz, /*out*/ float& depth) const
+			{
+				// OMAF Referential: x forward, y left, z up
+				// Image plane: x right, y down
+				if (xyz[0] > 0.f) {
+					depth = xyz[0];
+					return cv::Vec2f(
+						-f[0] * xyz[1] / xyz[0] + p[0],
+						-f[1] * xyz[2] / xyz[0] + p[1]);
+				}
+				depth = std::numeric_limits<float>::quiet_NaN();
+				return cv::Vec2f::all(depth);
+			}
+
+			cv::Vec2f f;
+			cv::Vec2f p;
+		};
 	};
 }
 
@@ -55,29 +55,22 @@ namespace rvs
 		: Unprojector(parameters)
 	{}
 
+	PerspectiveUnprojector::Kernel::Kernel(Parameters const& parameters)
+		: f(parameters.getFocal())
+		, p(parameters.getPrinciplePoint())
+	{}
+
 	cv::Mat3f PerspectiveUnprojector::unproject(cv::Mat2f image_pos, cv::Mat1f depth) const
 	{
 		assert(image_pos.size() == depth.size());
 
-		auto f = getParameters().getFocal();
-		auto p = getParameters().getPrinciplePoint();
+		Kernel kernel(getParameters());
 
 		cv::Mat3f world_pos(image_pos.size(), cv::Vec3f::all(NaN));
 
 		for (int i = 0; i != image_pos.rows; ++i) {
 			for (int j = 0; j != image_pos.cols; ++j) {
-				auto uv = image_pos(i, j);
-				auto d = depth(i, j);
-
-				// OMAF Referential: x forward, y left, z up
-				// Image plane: x right, y down
-
-				if (d > 0.f) {
-					world_pos(i, j) = cv::Vec3f(
-						d,
-						-(d / f[0]) * (uv[0] - p[0]),
-						-(d / f[1]) * (uv[1] - p[1]));
-				}
+				world_pos(i, j) = kernel(image_pos(i, j), depth(i, j));
 			}
 		}
 
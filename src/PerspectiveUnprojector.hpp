@@ -48,6 +48,8 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "Unprojector.hpp"
 #include "Config.hpp"
 
+#include <limits>
+
 /**
 @file PerspectiveUnprojector.hpp
 */
@@ -74,6 +76,28 @@ namespace rvs
 		@return Map of the pixels in euclidian coordinates
 		*/
 		cv::Mat3f unproject(cv::Mat2f image_pos, cv::Mat1f depth) const override;
+
+		/**\brief Unprojection of a single point, inlined in the warp kernels (see GenericTransformer::warp())*/
+		struct Kernel
+		{
+			explicit Kernel(Parameters const& parameters);
+
+			cv::Vec3f operator()(cv::Vec2f uv, float depth) const
+			{
+				// OMAF Referential: x forward, y left, z up
+				// Image plane: x right, y down
+				if (depth > 0.f) {
+					return cv::Vec3f(
+						depth,
+						-(depth / f[0]) * (uv[0] - p[0]),
+						-(depth / f[1]) * (uv[1] - p[1]));
+				}
+				return cv::Vec3f::all(std::numeric_limits<float>::quiet_NaN());
+			}
+
+			cv::Vec2f f;
+			cv::Vec2f p;
+		};
 	};
 }
 
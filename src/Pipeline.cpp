@@ -47,39 +47,240 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "Pipeline.hpp"
 #include "BlendedView.hpp"
 #include "SynthesizedView.hpp"
+#include "culling.hpp"
 #include "inpainting.hpp"
 
 #include <algorithm>
+#include <exception>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <memory>
+#include <utility>
 
 #include <opencv2/imgproc.hpp>
 
 #if WITH_OPENGL
+#include "BatchedSynthesis.hpp"
 #include "helpersGL.hpp"
 #include "RFBO.hpp"
 #endif
 
 namespace rvs
 {
-	Pipeline::Pipeline()
+	extern bool g_verbose;
+
+	Pipeline::Pipeline(bool with_opengl)
 	{
 #ifndef NDEBUG
 		cv::setBreakOnError(true);
+#endif
+#if WITH_OPENGL
+		m_context.with_opengl = with_opengl;
+#else
+		(void)with_opengl;
 #endif
 	}
 
+	Pipeline::~Pipeline() {}
+
 	void Pipeline::execute()
 	{
+		// Per-pipeline state from the configuration
+		m_context.rescale = getConfig().precision;
+		m_context.color_space = getConfig().color_space;
+		m_context.tiled_oversampling = getConfig().tiled_oversampling && m_context.rescale != 1.f;
+		if (m_context.tiled_oversampling && m_context.with_opengl) {
+			throw std::runtime_error("TiledOversampling is not supported with OpenGL");
+		}
+		m_context.packed_views = getConfig().packed_views;
+		if (m_context.packed_views && m_context.with_opengl) {
+			throw std::runtime_error("PackedViews is not supported with OpenGL");
+		}
+		// The packed color is in half precision (11 significant bits), which is not enough for more than 10-bit output
+		for (auto const& params_virtual : getConfig().params_virtual) {
+			if (m_context.packed_views && params_virtual.getColorBitDepth() > 10) {
+				throw std::runtime_error("PackedViews requires a BitDepthColor of at most 10 bits for the virtual cameras");
+			}
+		}
+		if (getConfig().batched_rendering && m_context.with_opengl && (getConfig().vs_method != "Triangles"
+			|| getConfig().blending_method != "Simple" || getConfig().mesh_decimation > 0.f)) {
+			throw std::runtime_error("BatchedRendering requires the Triangles method, Simple blending and no MeshDecimation");
+		}
+
+		// Input views are only resident during one execution (unless the derived class keeps them): an embedding application
+		// may provide new input in between
+		if (!keepInputViews()) {
+			m_input_frame = -1;
+			m_input_views.clear();
+		}
+		m_pending_view = nullptr;
+#if WITH_OPENGL
+		if (m_context.with_opengl && !m_context.fbo) {
+			m_context.fbo = std::make_shared<opengl::RFBO>();
+			m_context.gpu_resources = std::make_shared<opengl::ResourceCache>();
+			m_gpu_timer.reset(new opengl::GpuTimer(number_of_timed_stages));
+		}
+#endif
+
 		for (auto virtualFrame = 0; virtualFrame < getConfig().number_of_output_frames; ++virtualFrame) {
 			auto inputFrame = getConfig().start_frame + virtualFrame;
 			if (getConfig().number_of_output_frames > 1) {
 				std::cout << std::string(5, '=') << " FRAME " << inputFrame << ' ' << std::string(80, '=') << std::endl;
 			}
-			for (auto virtualView = 0u; virtualView != getConfig().VirtualCameraNames.size(); ++virtualView) {
+			m_cpu_times.assign(number_of_timed_stages, 0.);
+			if (isParallel()) {
+				computeViewsInParallel(inputFrame, virtualFrame);
+			}
+			else {
+				for (auto virtualView = 0u; virtualView != getConfig().VirtualCameraNames.size(); ++virtualView) {
+					computeView(inputFrame, virtualFrame, virtualView);
+				}
+			}
+			if (virtualFrame + 1 == getConfig().number_of_output_frames) {
+				finishPendingView();
+			}
+			endFrameTimings(inputFrame);
+		}
+		flushTimings();
+	}
+
+	void Pipeline::finishPendingView()
+	{
+		if (m_pending_view) {
+			auto pending = std::move(m_pending_view);
+			m_pending_view = nullptr;
+			pending();
+		}
+	}
+
+	std::chrono::steady_clock::time_point Pipeline::beginStage(TimedStage stage)
+	{
+#if WITH_OPENGL
+		if (m_context.with_opengl) {
+			m_gpu_timer->begin(stage);
+		}
+#else
+		(void)stage;
+#endif
+		return std::chrono::steady_clock::now();
+	}
+
+	void Pipeline::endStage(TimedStage stage, std::chrono::steady_clock::time_point start)
+	{
+		addCpuTime(stage, start, -1);
+#if WITH_OPENGL
+		if (m_context.with_opengl) {
+			m_gpu_timer->end();
+		}
+#endif
+	}
+
+	void Pipeline::addCpuTime(TimedStage stage, std::chrono::steady_clock::time_point start, int inputFrame)
+	{
+		auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		auto cpu_times = &m_cpu_times;
+#if WITH_OPENGL
+		// The deferred view of the previous frame (see m_pending_view) finishes after that frame ended
+		if (inputFrame >= 0 && inputFrame == m_timed_frame) {
+			cpu_times = &m_timed_cpu_times;
+		}
+#else
+		(void)inputFrame;
+#endif
+#pragma omp critical(rvs_pipeline_timings)
+		(*cpu_times)[stage] += elapsed;
+	}
+
+	void Pipeline::endFrameTimings(int inputFrame)
+	{
+#if WITH_OPENGL
+		if (m_context.with_opengl) {
+			auto gpu_times = m_gpu_timer->end_frame();
+			if (m_timed_frame >= 0) {
+				reportTimings(m_timed_frame, m_timed_cpu_times, gpu_times);
+			}
+			m_timed_frame = inputFrame;
+			m_timed_cpu_times = m_cpu_times;
+			return;
+		}
+#endif
+		reportTimings(inputFrame, m_cpu_times, std::vector<double>());
+	}
+
+	void Pipeline::flushTimings()
+	{
+#if WITH_OPENGL
+		if (m_context.with_opengl && m_timed_frame >= 0) {
+			reportTimings(m_timed_frame, m_timed_cpu_times, m_gpu_timer->flush());
+			m_timed_frame = -1;
+		}
+#endif
+	}
+
+	void Pipeline::reportTimings(int inputFrame, std::vector<double> const& cpu_times, std::vector<double> const& gpu_times) const
+	{
+		if (!g_verbose) {
+			return;
+		}
+		const char* names[] = { "synthesis", "blending", "output" };
+		std::ostringstream stream;
+		stream << "Timings of frame " << inputFrame << ':' << std::fixed << std::setprecision(3);
+		for (auto stage = 0; stage != number_of_timed_stages; ++stage) {
+			stream << ' ' << names[stage] << ' ' << cpu_times[stage] << " ms";
+			if (!gpu_times.empty()) {
+				stream << " (GPU " << gpu_times[stage] << " ms)";
+			}
+			stream << (stage + 1 != number_of_timed_stages ? "," : "");
+		}
+		std::cout << stream.str() << std::endl;
+	}
+
+	bool Pipeline::isParallel() const
+	{
+		// A GL context is current on a single thread only
+		return getConfig().parallel_virtual_views && !m_context.with_opengl && getConfig().VirtualCameraNames.size() > 1;
+	}
+
+	void Pipeline::computeViewsInParallel(int inputFrame, int virtualFrame)
+	{
+		auto const& config = getConfig();
+
+		// Load, unproject and triangulate all input views of this frame up front, such that the tasks only read them
+		int frame_to_load = getExtendedIndex(inputFrame, config.number_of_frames);
+		for (auto inputView = 0u; inputView != config.InputCameraNames.size(); ++inputView) {
+			auto const& params_real = config.params_real[inputView];
+			auto inputImage = getInputView(frame_to_load, inputView, params_real);
+			if (inputImage->get_world_pos().empty()) {
+				GenericTransformer transformer;
+				transformer.set_inputPosition(&params_real);
+				inputImage->set_world_pos(transformer.unproject(transformer.generateImagePos(), inputImage->get_depth()));
+			}
+			createSynthesizer(inputView, 0)->prepare(*inputImage, params_real);
+		}
+
+		// Each task has its own blender and space transformer, and shares the context of the pipeline
+		auto const numberOfViews = static_cast<int>(config.VirtualCameraNames.size());
+		std::exception_ptr error;
+
+#pragma omp parallel for schedule(dynamic) default(shared)
+		for (int virtualView = 0; virtualView < numberOfViews; ++virtualView) {
+			try {
 				computeView(inputFrame, virtualFrame, virtualView);
 			}
+			catch (...) {
+#pragma omp critical(rvs_pipeline_error)
+				{
+					if (!error) {
+						error = std::current_exception();
+					}
+				}
+			}
+		}
+
+		if (error) {
+			std::rethrow_exception(error);
 		}
 	}
 
@@ -133,6 +334,11 @@ namespace rvs
 		throw std::logic_error(std::string(__func__) + " not implemented");
 	}
 
+	bool Pipeline::keepInputViews() const
+	{
+		return false;
+	}
+
 	void Pipeline::onIntermediateSynthesisResult(int, int, int, int, SynthesizedView const&) {}
 
 	void Pipeline::onIntermediateBlendingResult(int, int, int, int, BlendedView const&) {}
@@ -165,23 +371,33 @@ namespace rvs
 		// Initialize OpenGL frame buffer objects
 #if WITH_OPENGL
 		auto intermediateSize = cv::Size(
-			int(detail::g_rescale*params_virtual.getSize().width),
-			int(detail::g_rescale*params_virtual.getSize().height));
-		if (g_with_opengl) {
-			auto FBO = opengl::RFBO::getInstance();
-			FBO->init(intermediateSize);
+			int(m_context.rescale*params_virtual.getSize().width),
+			int(m_context.rescale*params_virtual.getSize().height));
+		if (m_context.with_opengl) {
+			m_context.fbo->init(intermediateSize);
 		}
 #endif
 
 		// Setup a view blender
 		auto blender = createBlender(virtualView);
+		blender->setContext(m_context);
 
 		// Partial setup of a space transformer
 		auto spaceTransformer = createSpaceTransformer(virtualView);
 		spaceTransformer->set_targetPosition(&params_virtual);
 
-		// For each input view
-		for (auto inputView = 0u; inputView != getConfig().InputCameraNames.size(); ++inputView) {
+		auto inputViews = selectInputViews(virtualView, params_virtual);
+
+		// All input views in one pass (if possible)
+		auto batched = false;
+#if WITH_OPENGL
+		if (m_context.with_opengl && getConfig().batched_rendering) {
+			batched = synthesizeBatched(inputFrame, virtualView, inputViews, *spaceTransformer);
+		}
+#endif
+
+		// For each input view that may contribute
+		for (auto inputView : batched ? std::vector<unsigned>() : inputViews) {
 			std::cout << getConfig().InputCameraNames[inputView] << " => " << getConfig().VirtualCameraNames[virtualView] << std::endl;
 			auto const& params_real = getConfig().params_real[inputView];
 
@@ -191,30 +407,34 @@ namespace rvs
 			// Setup a view synthesizer
 			auto synthesizer = createSynthesizer(inputView, virtualView);
 			synthesizer->setSpaceTransformer(spaceTransformer.get());
+			synthesizer->setContext(m_context);
 
 			//posetrace longer that input view: back and forwards in the input video
 			int frame_to_load = getExtendedIndex(inputFrame, getConfig().number_of_frames);
-			std::cout << "loading... " << frame_to_load << std::endl;
 			// Load the input image
-			auto inputImage = loadInputView(frame_to_load, inputView, params_real);
+			auto inputImage = getInputView(frame_to_load, inputView, params_real);
 
 			// Start OpenGL instrumentation (if any)
 #if WITH_OPENGL
-			if (g_with_opengl) {
+			if (m_context.with_opengl) {
 				opengl::rd_start_capture_frame();
 			}
 #endif
 			// Synthesize view
+			auto start = beginStage(stage_synthesis);
 			synthesizer->compute(*inputImage);
+			endStage(stage_synthesis, start);
 			onIntermediateSynthesisResult(inputFrame, inputView, virtualFrame, virtualView, *synthesizer);
 
 			// Blend with previous results
+			start = beginStage(stage_blending);
 			blender->blend(*synthesizer);
+			endStage(stage_blending, start);
 			onIntermediateBlendingResult(inputFrame, inputView, virtualFrame, virtualView, *blender);
 
 			// End OpenGL instrumentation (if any)
 #if WITH_OPENGL
-			if (g_with_opengl) {
+			if (m_context.with_opengl) {
 				opengl::rd_end_capture_frame();
 			}
 #endif
@@ -222,31 +442,98 @@ namespace rvs
 
 		onFinalBlendingResult(inputFrame, virtualFrame, virtualView, *blender);
 
-		// Download maps from GPU
+		// Start downloading the output frame from the GPU, finish the previous view while the transfer runs, and defer this one
+#if WITH_OPENGL
+		if (m_context.with_opengl) {
+			auto start = beginStage(stage_output);
+			blender->requestOutputFromGL(params_virtual.getSize(), getConfig().validity_threshold);
+			endStage(stage_output, start);
+			m_context.fbo->free();
+
+			std::shared_ptr<BlendedView> pending(std::move(blender));
+			finishPendingView();
+			m_pending_view = [this, virtualFrame, virtualView, params_virtual, pending]() {
+				finishView(virtualFrame, virtualView, params_virtual, *pending);
+			};
+			return;
+		}
+#endif
+		finishView(virtualFrame, virtualView, params_virtual, *blender);
+	}
+
+	bool Pipeline::synthesizeBatched(int inputFrame, int virtualView, std::vector<unsigned> const& inputViews, SpaceTransformer& spaceTransformer)
+	{
+#if WITH_OPENGL
+		if (inputViews.empty() || inputViews.size() > std::size_t(opengl::BatchedViewParameters::max_views)) {
+			return false;
+		}
+		auto const& size = getConfig().params_real[inputViews.front()].getSize();
+		for (auto inputView : inputViews) {
+			auto const& params_real = getConfig().params_real[inputView];
+			if (params_real.getDisplacementMethod() != DisplacementMethod::depth || params_real.getSize() != size) {
+				return false;
+			}
+		}
+
+		// Load the input views, and the parameters to warp each of them
+		int frame_to_load = getExtendedIndex(inputFrame, getConfig().number_of_frames);
+		std::vector<std::shared_ptr<View>> inputs;
+		std::vector<opengl::ViewParameters> parameters;
+		for (auto inputView : inputViews) {
+			std::cout << getConfig().InputCameraNames[inputView] << " => " << getConfig().VirtualCameraNames[virtualView] << " (batched)" << std::endl;
+			auto const& params_real = getConfig().params_real[inputView];
+			spaceTransformer.set_inputPosition(&params_real);
+			inputs.push_back(getInputView(frame_to_load, inputView, params_real));
+			parameters.push_back(opengl::view_parameters(*inputs.back(), spaceTransformer));
+		}
+
+		opengl::rd_start_capture_frame();
+		auto start = beginStage(stage_synthesis);
+		opengl::synthesize_batched(inputs, parameters, m_context, getConfig().blending_factor);
+		endStage(stage_synthesis, start);
+		opengl::rd_end_capture_frame();
+		return true;
+#else
+		(void)inputFrame;
+		(void)virtualView;
+		(void)inputViews;
+		(void)spaceTransformer;
+		return false;
+#endif
+	}
+
+	void Pipeline::finishView(int virtualFrame, int virtualView, Parameters const& params_virtual, BlendedView& blender)
+	{
+		auto start = std::chrono::steady_clock::now();
+		cv::Mat3f color;
+		cv::Mat1b mask;
+
+		// Download the output frame from the GPU: inpainted, downscaled and masked there
 #if WITH_OPENGL
-		if (g_with_opengl) {
-			blender->assignFromGL2CV(intermediateSize);
+		if (m_context.with_opengl) {
+			blender.assignOutputFromGL2CV(params_virtual.getSize(), color, mask);
 		}
 #endif
+		if (!m_context.with_opengl) {
+			// Perform inpainting (the synthesized views are already resolved with tiled oversampling)
+			color = detail::inpaint(blender.get_color(), blender.get_inpaint_mask(), true, m_context.tiled_oversampling ? 1.f : m_context.rescale);
 
-		// Perform inpainting
-		cv::Mat3f color = detail::inpaint(blender->get_color(), blender->get_inpaint_mask(), true);
+			// Downscale (when g_Precision != 1)
+			resize(color, color, params_virtual.getSize());
 
-		// Downscale (when g_Precision != 1)
-		resize(color, color, params_virtual.getSize());
+			// Compute mask (activated by OutputMasks or MaskedOutputFiles or MaskedDepthOutputFiles)
+			if (wantMask() || wantMaskedColor() || wantMaskedDepth()) {
+				mask = blender.get_validity_mask(getConfig().validity_threshold);
+				resize(mask, mask, params_virtual.getSize(), cv::INTER_NEAREST);
+			}
+		}
+		addCpuTime(stage_output, start, getConfig().start_frame + virtualFrame);
 
 		// Write regular output (activated by OutputFiles)
 		if (wantColor()) {
 			saveColor(color, virtualFrame, virtualView, params_virtual);
 		}
 
-		// Compute mask (activated by OutputMasks or MaskedOutputFiles or MaskedDepthOutputFiles)
-		cv::Mat1b mask;
-		if (wantMask() || wantMaskedColor() || wantMaskedDepth()) {
-			mask = blender->get_validity_mask(getConfig().validity_threshold);
-			resize(mask, mask, params_virtual.getSize(), cv::INTER_NEAREST);
-		}
-
 		// Write mask (activated by OutputMasks)
 		if (wantMask()) {
 			saveMask(mask, virtualFrame, virtualView, params_virtual);
@@ -260,24 +547,86 @@ namespace rvs
 
 		// Write depth maps (activated by DepthOutputFiles)
 		if (wantDepth()) {
-			auto depth = blender->get_depth();
+			auto depth = blender.get_depth();
 			resize(depth, depth, params_virtual.getSize());
 			saveDepth(depth, virtualFrame, virtualView, params_virtual);
 		}
 
 		// Write masked depth maps (activated by MaskedDepthOutputFiles)
 		if (wantMaskedDepth()) {
-			auto depth = blender->get_depth();
+			auto depth = blender.get_depth();
 			resize(depth, depth, params_virtual.getSize());
 			saveMaskedDepth(depth, mask, virtualFrame, virtualView, params_virtual);
 		}
+	}
 
-#if WITH_OPENGL
-		if (g_with_opengl) {
-			auto FBO = opengl::RFBO::getInstance();
-			FBO->free();
+	std::shared_ptr<View> Pipeline::getInputView(int inputFrame, int inputView, Parameters const& parameters)
+	{
+		// Keep input views resident only when all output frames are synthesized from the same input frame,
+		// or when the virtual views of a frame are computed in parallel
+		if (getConfig().number_of_frames != 1 && !isParallel()) {
+			std::cout << "loading... " << inputFrame << std::endl;
+			return loadInputView(inputFrame, inputView, parameters);
 		}
-#endif
+
+		if (m_input_frame != inputFrame) {
+			m_input_views.assign(getConfig().InputCameraNames.size(), nullptr);
+			m_input_frame = inputFrame;
+		}
+
+		auto& inputImage = m_input_views[inputView];
+		if (!inputImage) {
+			std::cout << "loading... " << inputFrame << std::endl;
+			inputImage = loadInputView(inputFrame, inputView, parameters);
+		}
+		return inputImage;
+	}
+
+	std::vector<unsigned> Pipeline::selectInputViews(int virtualView, Parameters const& params_virtual) const
+	{
+		auto const& config = getConfig();
+		auto distance = [&](unsigned inputView) {
+			return cv::norm(config.params_real[inputView].getPosition() - params_virtual.getPosition());
+		};
+		std::vector<unsigned> selected;
+
+		// Skip input views that do not overlap with the virtual view
+		for (auto inputView = 0u; inputView != config.InputCameraNames.size(); ++inputView) {
+			if (config.input_view_culling && !detail::isOverlapping(config.params_real[inputView], params_virtual)) {
+				std::cout << "Skipping " << config.InputCameraNames[inputView] << " => " << config.VirtualCameraNames[virtualView] << " (no overlap)" << std::endl;
+			}
+			else {
+				selected.push_back(inputView);
+			}
+		}
+
+		// The blender needs at least one view, so fall back to the nearest input view
+		if (selected.empty() && !config.InputCameraNames.empty()) {
+			auto nearest = 0u;
+			for (auto inputView = 1u; inputView != config.InputCameraNames.size(); ++inputView) {
+				if (distance(inputView) < distance(nearest)) {
+					nearest = inputView;
+				}
+			}
+			selected.push_back(nearest);
+		}
+
+		// Keep only the nearest input views
+		auto max_input_views = static_cast<std::size_t>(config.max_input_views);
+		if (max_input_views != 0 && selected.size() > max_input_views) {
+			auto nearest = selected;
+			std::stable_sort(nearest.begin(), nearest.end(), [&](unsigned a, unsigned b) {
+				return distance(a) < distance(b);
+			});
+			for (auto i = max_input_views; i != nearest.size(); ++i) {
+				std::cout << "Skipping " << config.InputCameraNames[nearest[i]] << " => " << config.VirtualCameraNames[virtualView] << " (not among the " << max_input_views << " nearest)" << std::endl;
+			}
+			nearest.resize(max_input_views);
+			std::sort(nearest.begin(), nearest.end());
+			selected = nearest;
+		}
+
+		return selected;
 	}
 
 	std::unique_ptr<BlendedView> Pipeline::createBlender(int)
@@ -290,6 +639,13 @@ namespace rvs
 			return std::unique_ptr<BlendedView>(new BlendedViewMultiSpec(getConfig().blending_low_freq_factor, getConfig().blending_high_freq_factor));
 		}
 
+		if (getConfig().blending_method == BlendingMethod::laplacian) {
+			if (m_context.with_opengl) {
+				throw std::runtime_error("Laplacian blending is not supported with OpenGL");
+			}
+			return std::unique_ptr<BlendedView>(new BlendedViewLaplacian(getConfig().blending_factor));
+		}
+
 		std::ostringstream what;
 		what << "Unknown view blending method \"" << getConfig().blending_method << "\"";
 		throw std::runtime_error(what.str());
@@ -298,7 +654,25 @@ namespace rvs
 	std::unique_ptr<SynthesizedView> Pipeline::createSynthesizer(int, int)
 	{
 		if (getConfig().vs_method == ViewSynthesisMethod::triangles) {
-			return std::unique_ptr<SynthesizedView>(new SynthetisedViewTriangle);
+			auto synthesizer = std::unique_ptr<SynthesizedView>(new SynthetisedViewTriangle);
+			synthesizer->setMeshDecimation(getConfig().mesh_decimation);
+			synthesizer->setOcclusionOrder(getConfig().occlusion_order);
+			return synthesizer;
+		}
+		if (getConfig().vs_method == ViewSynthesisMethod::backward_warp) {
+			if (m_context.with_opengl) {
+				throw std::runtime_error("View synthesis method \"BackwardWarp\" is not available with OpenGL");
+			}
+			auto synthesizer = std::unique_ptr<SynthesizedView>(new SynthetisedViewBackwardWarp);
+			synthesizer->setMeshDecimation(getConfig().mesh_decimation);
+			synthesizer->setOcclusionOrder(getConfig().occlusion_order);
+			return synthesizer;
+		}
+		if (getConfig().vs_method == ViewSynthesisMethod::splat) {
+			if (m_context.with_opengl) {
+				throw std::runtime_error("View synthesis method \"Splat\" is not available with OpenGL");
+			}
+			return std::unique_ptr<SynthesizedView>(new SynthetisedViewSplat(getConfig().splat_size));
 		}
 
 		std::ostringstream what;
@@ -309,7 +683,7 @@ namespace rvs
 	std::unique_ptr<SpaceTransformer> Pipeline::createSpaceTransformer(int)
 	{
 #if WITH_OPENGL
-		if (g_with_opengl) {
+		if (m_context.with_opengl) {
 			return std::unique_ptr<SpaceTransformer>(new OpenGLTransformer);
 		}
 #endif
@@ -50,6 +50,11 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "View.hpp"
 #include "Config.hpp"
 
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
 namespace rvs 
 {
 	class BlendedView;
@@ -77,8 +82,14 @@ namespace rvs
 	public:
 		/**
 		\brief Constructor
+		@param with_opengl Enable OpenGL acceleration (requires a current OpenGL context, ignored without WITH_OPENGL)
 		*/
-		Pipeline();
+		Pipeline(bool with_opengl = false);
+
+		/**
+		\brief Destructor
+		*/
+		virtual ~Pipeline();
 
 		/**
 		\brief Execution of the view synthesis
@@ -93,6 +104,11 @@ namespace rvs
 		*/
 		virtual Config const& getConfig() const = 0;
 
+		/**
+		\brief Context of this pipeline (precision, color space, OpenGL), initialized from the configuration by execute()
+		*/
+		Context const& getContext() const { return m_context; }
+
 		/**
 		\brief Interface for loading a source view. Implemented by Application
 		*/
@@ -123,6 +139,13 @@ namespace rvs
 		*/
 		virtual bool wantMaskedDepth();
 
+		/**
+		\brief Does the derived class keep the resident input views between executions? (see getInputView())
+
+		Only for input that does not change between executions, e.g. a server that synthesizes one static scene repeatedly.
+		*/
+		virtual bool keepInputViews() const;
+
 		/**
 		\brief Interface for saving a regular (inpainted) synthesis result. Implemented by Application
 		*/
@@ -151,14 +174,14 @@ namespace rvs
 		/**
 		\brief Interface for making intermediate result available for pruning or analysis
 
-		Pipeline calls this function after synthesizing a single input view
+		Pipeline calls this function after synthesizing a single input view, except with BatchedRendering
 		*/
 		virtual void onIntermediateSynthesisResult(int inputFrame, int inputView, int virtualFrame, int virtualView, SynthesizedView const& synthesizedView);
 
 		/**
 		\brief Interface for making intermediate result available for pruning or analysis
 
-		Pipeline calls this function after synthesizing a single input view
+		Pipeline calls this function after synthesizing a single input view, except with BatchedRendering
 		*/
 		virtual void onIntermediateBlendingResult(int inputFrame, int inputView, int virtualFrame, int virtualView, BlendedView const& blendedView);
 
@@ -166,7 +189,7 @@ namespace rvs
 		\brief Interface for making intermediate result available for pruning or analysis
 
 		Pipeline calls this function after synthesizing a single input view
-		With OpenGL the result is available through opengl::RFBO::getInstance()
+		With OpenGL the result is available through getContext().fbo
 		Otherwise the result is available through the blendedView parameter
 		*/
 		virtual void onFinalBlendingResult(int inputFrame, int virtualFrame, int virtualView, BlendedView const& blendedView);
@@ -196,6 +219,140 @@ namespace rvs
 		@param virtualView Index of the virtual view to compute
 		*/
 		void computeView(int inputFrame, int virtualFrame, int virtualView);
+
+		/**
+		\brief Finishes one frame of a virtual view: inpainting, downscaling, masking and writing
+
+		With OpenGL these are done on the GPU, and only the output frame is downloaded (see BlendedView::requestOutputFromGL()).
+
+		@param virtualFrame Virtual (output) frame number of the frame
+		@param virtualView Index of the virtual view
+		@param params_virtual Virtual camera parameters for this frame (including the pose trace)
+		@param blender Blending result of the view
+		*/
+		void finishView(int virtualFrame, int virtualView, Parameters const& params_virtual, BlendedView& blender);
+
+		/**
+		\brief Warps and blends all input views of a virtual view on the GPU in one pass (BatchedRendering)
+
+		The input views are only loaded when the batch applies: at most opengl::BatchedViewParameters::max_views input views
+		with depth maps of the size of the first one. The blending result is then in the frame buffer object, as after the
+		blending of the last input view, but the intermediate result callbacks are not called.
+		@param inputFrame Input frame number of the frame to compute
+		@param virtualView Index of the virtual view
+		@param inputViews Indices of the selected input views (see selectInputViews())
+		@param spaceTransformer Space transformer with the target position of the virtual view
+		@return false when the input views do not fit in one batch, and nothing was done
+		*/
+		bool synthesizeBatched(int inputFrame, int virtualView, std::vector<unsigned> const& inputViews, SpaceTransformer& spaceTransformer);
+
+		/**
+		\brief Finishes the deferred view, if any (see m_pending_view)
+		*/
+		void finishPendingView();
+
+		/**
+		\brief Are the virtual views of a frame computed in parallel?
+
+		Only when ParallelVirtualViews is set, without OpenGL, and with more than one virtual view.
+		*/
+		bool isParallel() const;
+
+		/**
+		\brief Computes one frame of all virtual views in parallel
+
+		The input views of the frame are loaded and unprojected once, and are then shared read-only by the tasks. Each virtual view
+		is a task with its own blender and space transformer. The save and intermediate result callbacks are called from the tasks.
+		@param inputFrame Input frame number of the frame to compute
+		@param virtualFrame Virtual (output) frame number of the frame to compute
+		*/
+		void computeViewsInParallel(int inputFrame, int virtualFrame);
+
+		/**
+		\brief Load an input view, or reuse it when the scene is static
+
+		When there is a single input frame (e.g. a pose trace over a static capture), the input views are
+		loaded once and kept resident together with their unprojected geometry (see View::get_world_pos()).
+		Every output frame then only repeats the transformation, projection, rasterization and blending.
+		@param inputFrame Input frame number to load
+		@param inputView Index of the input view to load
+		@param parameters Camera parameters of the input view
+		*/
+		std::shared_ptr<View> getInputView(int inputFrame, int inputView, Parameters const& parameters);
+
+		/**
+		\brief Select the input views to warp to a virtual view
+
+		Without InputViewCulling and MaxInputViews all input views are selected. Otherwise input views that cannot contribute
+		to the virtual view are skipped (see detail::isOverlapping()), and of the remaining views only the MaxInputViews nearest
+		to the virtual camera are kept. Skipped views are logged.
+		@param virtualView Index of the virtual view
+		@param params_virtual Virtual camera parameters for this frame (including the pose trace)
+		@return Indices of the selected input views in increasing order
+		*/
+		std::vector<unsigned> selectInputViews(int virtualView, Parameters const& params_virtual) const;
+
+		/** Timed stages of the view computation, reported per frame (see reportTimings()) */
+		enum TimedStage { stage_synthesis, stage_blending, stage_output, number_of_timed_stages };
+
+		/**
+		\brief Start timing a stage of the current frame: CPU time, and GPU time with OpenGL (see opengl::GpuTimer)
+
+		@return Start time, see endStage()
+		*/
+		std::chrono::steady_clock::time_point beginStage(TimedStage stage);
+
+		/** \brief Stop timing a stage started by beginStage() */
+		void endStage(TimedStage stage, std::chrono::steady_clock::time_point start);
+
+		/**
+		\brief Add the CPU time since start to a stage of a frame (thread-safe)
+
+		@param inputFrame Frame of the stage, or -1 for the current frame
+		*/
+		void addCpuTime(TimedStage stage, std::chrono::steady_clock::time_point start, int inputFrame);
+
+		/**
+		\brief End the timings of a frame, and report the timings that are complete
+
+		With OpenGL the GPU times of a frame are only read at the end of the next frame, or by flushTimings() for the last frame.
+		*/
+		void endFrameTimings(int inputFrame);
+
+		/** \brief Report the timings of the last frame, if still pending */
+		void flushTimings();
+
+		/** \brief Report the CPU and GPU (if any) time per stage of a frame (when verbose) */
+		void reportTimings(int inputFrame, std::vector<double> const& cpu_times, std::vector<double> const& gpu_times) const;
+
+		/** Per-pipeline state that is shared with the view synthesizers and blenders */
+		Context m_context;
+
+		/** Input frame of the resident input views */
+		int m_input_frame = -1;
+
+		/** Resident input views (only for static scenes) */
+		std::vector<std::shared_ptr<View>> m_input_views;
+
+		/**
+		\brief With OpenGL the finishing of a view is deferred until the GPU work of the next view is issued
+
+		The readback of the view is then asynchronous, and its writing on the CPU overlaps with the warping of the next view on
+		the GPU.
+		*/
+		std::function<void()> m_pending_view;
+
+		/** CPU time in milliseconds per stage of the current frame */
+		std::vector<double> m_cpu_times;
+
+#if WITH_OPENGL
+		/** GPU time of the stages, collected one frame later */
+		std::unique_ptr<opengl::GpuTimer> m_gpu_timer;
+
+		/** Frame and CPU times of which the GPU times are pending */
+		int m_timed_frame = -1;
+		std::vector<double> m_timed_cpu_times;
+#endif
 	};
 }
 
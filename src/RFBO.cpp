@@ -45,13 +45,16 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 */
 
 #include "RFBO.hpp"
+#include "Shader.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 
 namespace rvs
 {
 	namespace opengl
 	{
-		RFBO * RFBO::_singleton = nullptr;
-
 		void RFBO::toggle()
 		{
 			validate();
@@ -108,6 +111,45 @@ namespace rvs
 
 			return texture;
 		}
+		GLuint RFBO::create_texture_array(int count, GLenum attachement_type, GLenum internalformat)
+		{
+			validate();
+			GLenum format = GL_RED;
+			GLenum type = GL_FLOAT;
+			if (internalformat == GL_RGB32F)
+				format = GL_RGB;
+			if (internalformat == GL_DEPTH24_STENCIL8) {
+				format = GL_DEPTH_STENCIL;
+				type = GL_UNSIGNED_INT_24_8;
+			}
+
+			GLuint texture;
+			glGenTextures(1, &texture);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalformat, m_size.width, m_size.height, count, 0, format, type, 0);
+
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+			// All layers are attached: the geometry shader selects the layer
+			glFramebufferTexture(GL_FRAMEBUFFER, attachement_type, texture, 0);
+
+			return texture;
+		}
+
+		GLuint RFBO::create_image(cv::Size size, GLenum internalformat)
+		{
+			GLuint texture;
+			glGenTextures(1, &texture);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexStorage2D(GL_TEXTURE_2D, 1, internalformat, size.width, size.height);
+
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+			return texture;
+		}
+
 		void RFBO::delete_texture_buffer(GLuint texture)
 		{
 			glBindTexture(GL_TEXTURE_2D, 0);
@@ -118,6 +160,7 @@ namespace rvs
 		{
 			setGLContext();
 			glViewport(0, 0, size.width, size.height);
+			m_size = size;
 
 			glGenFramebuffers(1, &ID);
 			glBindFramebuffer(GL_FRAMEBUFFER, ID);
@@ -148,10 +191,167 @@ namespace rvs
 				exit(1);
 			}
 
+			seeds[0] = create_image(size, GL_RG32I);
+			seeds[1] = create_image(size, GL_RG32I);
+
 			glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
 		}
 
+		int RFBO::request_output(cv::Size output_size, float validity_threshold)
+		{
+			validate();
+			auto const& shaders = ShadersList::getInstance();
+			if (output_size != m_output_size) {
+				free_output();
+				output_image = create_image(output_size, GL_RGBA32F);
+				output_mask = create_image(output_size, GL_R8);
+				m_output_size = output_size;
+			}
+
+			// Work groups of 16x16 pixels
+			auto groups_x = GLuint((m_size.width + 15) / 16);
+			auto groups_y = GLuint((m_size.height + 15) / 16);
+
+			// The known pixels are the seeds
+			auto const& seed = shaders("inpaint_seed");
+			glUseProgram(seed.getProgramID());
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, swap_quality[value]);
+			glUniform1i(seed.uniform("blended_quality"), 0);
+			glBindImageTexture(0, seeds[0], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32I);
+			glDispatchCompute(groups_x, groups_y, 1);
+
+			// Jump flooding with halving step lengths, and one more step of one pixel that corrects most of its errors
+			std::vector<int> steps;
+			for (auto step = 1; step < std::max(m_size.width, m_size.height); step *= 2) {
+				steps.insert(steps.begin(), step);
+			}
+			steps.push_back(1);
+
+			auto const& jump = shaders("inpaint_jump");
+			glUseProgram(jump.getProgramID());
+			auto current = 0;
+			for (auto step : steps) {
+				glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+				glBindImageTexture(0, seeds[current], 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG32I);
+				glBindImageTexture(1, seeds[1 - current], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32I);
+				glUniform1i(jump.uniform("step_length"), step);
+				glDispatchCompute(groups_x, groups_y, 1);
+				current = 1 - current;
+			}
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+			// Inpainted, downscaled and flipped color, and the validity mask, at the output size
+			auto const& output = shaders("inpaint_output");
+			glUseProgram(output.getProgramID());
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, swap_image[value]);
+			glUniform1i(output.uniform("blended_image"), 0);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, swap_quality[value]);
+			glUniform1i(output.uniform("blended_quality"), 1);
+			glUniform1f(output.uniform("validity_threshold"), validity_threshold);
+			glBindImageTexture(0, seeds[current], 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG32I);
+			glBindImageTexture(1, output_image, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+			glBindImageTexture(2, output_mask, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+			glDispatchCompute(GLuint((output_size.width + 15) / 16), GLuint((output_size.height + 15) / 16), 1);
+			glMemoryBarrier(GL_PIXEL_BUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+			glUseProgram(0);
+
+			// Read color and mask into one pixel buffer
+			auto color_bytes = GLsizeiptr(output_size.area()) * 3 * sizeof(GLfloat);
+			auto slot = readback.acquire(color_bytes + GLsizeiptr(output_size.area()));
+
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+			glBindTexture(GL_TEXTURE_2D, output_image);
+			glGetTexImage(GL_TEXTURE_2D, 0, GL_BGR, GL_FLOAT, nullptr);
+			glBindTexture(GL_TEXTURE_2D, output_mask);
+			glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_BYTE, reinterpret_cast<GLvoid*>(color_bytes));
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			readback.fence(slot);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+			// Start the transfer now, the CPU only waits in map_output()
+			glFlush();
+			return slot;
+		}
+
+		void RFBO::map_output(int slot, cv::Size output_size, cv::Mat3f& color, cv::Mat1b& mask)
+		{
+			auto color_bytes = GLsizeiptr(output_size.area()) * 3 * sizeof(GLfloat);
+			auto bytes = color_bytes + GLsizeiptr(output_size.area());
+
+			readback.wait(slot);
+			readback.bind(slot);
+			auto data = static_cast<uchar*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT));
+			if (!data) {
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+				throw std::runtime_error("Failed to map the readback buffer");
+			}
+			cv::Mat(output_size, CV_32FC3, data).copyTo(color);
+			cv::Mat(output_size, CV_8UC1, data + color_bytes).copyTo(mask);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		}
+
+		void RFBO::free_output()
+		{
+			if (!output_image)
+				return;
+			delete_texture_buffer(output_image);
+			delete_texture_buffer(output_mask);
+			output_image = 0;
+			output_mask = 0;
+			m_output_size = cv::Size();
+		}
+
+		void RFBO::init_layers(int count)
+		{
+			validate();
+			if (layers == count && m_layers_size == m_size)
+				return;
+			free_layers();
+
+			glGenFramebuffers(1, &layered_ID);
+			glBindFramebuffer(GL_FRAMEBUFFER, layered_ID);
+
+			layered_image = create_texture_array(count, GL_COLOR_ATTACHMENT0, GL_RGB32F);
+			layered_depth = create_texture_array(count, GL_COLOR_ATTACHMENT1, GL_R32F);
+			layered_quality = create_texture_array(count, GL_COLOR_ATTACHMENT2, GL_R32F);
+			layered_depth_stencil = create_texture_array(count, GL_DEPTH_STENCIL_ATTACHMENT, GL_DEPTH24_STENCIL8);
+
+			GLuint attachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+			glDrawBuffers(3, attachments);
+
+			auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			if (status != GL_FRAMEBUFFER_COMPLETE) {
+				free_layers();
+				throw std::runtime_error("Failed to create the layered framebuffer");
+			}
+			layers = count;
+			m_layers_size = m_size;
+		}
+
+		void RFBO::free_layers()
+		{
+			if (!layered_ID)
+				return;
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glDeleteFramebuffers(1, &layered_ID);
+			layered_ID = 0;
+
+			delete_texture_buffer(layered_image);
+			delete_texture_buffer(layered_depth);
+			delete_texture_buffer(layered_quality);
+			delete_texture_buffer(layered_depth_stencil);
+			layers = 0;
+			m_layers_size = cv::Size();
+		}
+
 		void RFBO::free()
 		{
 			glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -168,6 +368,9 @@ namespace rvs
 			delete_texture_buffer(swap_image[1]);
 			delete_texture_buffer(swap_quality[1]);
 
+			delete_texture_buffer(seeds[0]);
+			delete_texture_buffer(seeds[1]);
+
 			glBindRenderbuffer(GL_RENDERBUFFER, 0);
 			glDeleteRenderbuffers(1, &depth_stencil);
 			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, 0, 0);
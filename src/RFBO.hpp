@@ -55,24 +55,24 @@ namespace rvs
 {
 	namespace opengl
 	{
+		/**
+		\brief Frame buffer objects of one pipeline (see Context)
+		*/
 		class RFBO
 		{
-		private:
+		public:
 			RFBO() {}
 			~RFBO()
 			{
 				// TODO delete OpenGL Buffers	
-				delete _singleton;
+				// The output frame and the layers outlive free(), they are only recreated when their size changes
+				free_output();
+				free_layers();
 				initialized = false;
 			}
 
-		public:
-			static RFBO * getInstance()
-			{
-				if (_singleton == nullptr)
-					_singleton = new RFBO();
-				return _singleton;
-			}
+			RFBO(RFBO const&) = delete;
+			RFBO& operator=(RFBO const&) = delete;
 
 			void init(cv::Size size)
 			{
@@ -91,9 +91,43 @@ namespace rvs
 
 			void free();
 
+			/**
+			\brief Create the layered framebuffer with one layer per input view (see synthesize_batched())
+
+			The layers have the size of this frame buffer object, and are only recreated when the number of layers or that size
+			changes.
+			*/
+			void init_layers(int count);
+
+			/**
+			\brief Start the asynchronous readback of the final output frame: inpainted, downscaled and masked on the GPU
+
+			The holes of the blending result are filled with the color of the nearest known pixel by jump flooding, as
+			detail::inpaint() on the CPU. The inpainted result is then downscaled to the output size (bilinear), and the
+			validity mask (see View::get_validity_mask()) is computed at the output size (nearest). Only these are read back.
+			@param output_size Size of the output frame
+			@param validity_threshold Validity threshold of the mask
+			@return Slot of the pixel buffer, see map_output()
+			*/
+			int request_output(cv::Size output_size, float validity_threshold);
+
+			/**
+			\brief Complete a readback started by request_output(), waiting for the GPU if needed
+
+			@param slot Slot returned by request_output()
+			@param output_size Size of the output frame
+			@param color Inpainted color at the output size
+			@param mask Validity mask at the output size: 255 for the invalid pixels
+			*/
+			void map_output(int slot, cv::Size output_size, cv::Mat3f& color, cv::Mat1b& mask);
+
 		private:
 			GLuint create_texture_buffer(cv::Size size, GLenum attachement_type, GLenum internalformat);
+			GLuint create_texture_array(int count, GLenum attachement_type, GLenum internalformat);
+			GLuint create_image(cv::Size size, GLenum internalformat);
 			void delete_texture_buffer(GLuint texture);
+			void free_layers();
+			void free_output();
 
 			void create_fbo(cv::Size size);
 
@@ -113,6 +147,21 @@ namespace rvs
 
 			GLint value = 0;
 
+			PixelBufferRing readback{ GL_PIXEL_PACK_BUFFER, 2 };
+
+			// Layered framebuffer of the batched synthesis: one layer per input view
+			GLuint layered_ID = 0;
+			GLuint layered_image = 0;
+			GLuint layered_depth = 0;
+			GLuint layered_quality = 0;
+			GLuint layered_depth_stencil = 0;
+			int layers = 0;
+
+			// Nearest known pixels of the inpainting (ping-pong), and the output frame
+			GLuint seeds[2] = { 0, 0 };
+			GLuint output_image = 0;
+			GLuint output_mask = 0;
+
 		private:
 			void validate(void) const
 			{
@@ -122,8 +171,10 @@ namespace rvs
 
 
 		private:
-			static RFBO * _singleton;
 			bool initialized = false;
+			cv::Size m_size;
+			cv::Size m_output_size;
+			cv::Size m_layers_size;
 		};
 	}
 }
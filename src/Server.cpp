@@ -0,0 +1,419 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+#include "Server.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace rvs
+{
+	namespace
+	{
+		[[noreturn]] void throwSystemError(char const *what)
+		{
+			std::ostringstream stream;
+			stream << what << ": " << std::strerror(errno);
+			throw std::runtime_error(stream.str());
+		}
+
+		sockaddr_un socketAddress(std::string const& socketpath)
+		{
+			sockaddr_un address{};
+			address.sun_family = AF_UNIX;
+			if (socketpath.size() >= sizeof(address.sun_path)) {
+				throw std::runtime_error("Socket path is too long");
+			}
+			std::strncpy(address.sun_path, socketpath.c_str(), sizeof(address.sun_path) - 1);
+			return address;
+		}
+
+		// Receive exactly size bytes, returns false when the peer closed the connection before the first byte
+		bool receiveAll(int socket, void *data, std::size_t size)
+		{
+			auto bytes = static_cast<char*>(data);
+			for (std::size_t done = 0; done != size;) {
+				auto n = ::recv(socket, bytes + done, size - done, 0);
+				if (n < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					throwSystemError("Failed to receive");
+				}
+				if (n == 0) {
+					if (done == 0) {
+						return false;
+					}
+					throw std::runtime_error("Connection closed in the middle of a message");
+				}
+				done += static_cast<std::size_t>(n);
+			}
+			return true;
+		}
+
+		void sendAll(int socket, void const *data, std::size_t size)
+		{
+			auto bytes = static_cast<char const*>(data);
+			for (std::size_t done = 0; done != size;) {
+				auto n = ::send(socket, bytes + done, size - done, MSG_NOSIGNAL);
+				if (n < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					throwSystemError("Failed to send");
+				}
+				done += static_cast<std::size_t>(n);
+			}
+		}
+
+		// Is there data waiting on the socket?
+		bool isReadable(int socket)
+		{
+			pollfd fd{};
+			fd.fd = socket;
+			fd.events = POLLIN;
+			return ::poll(&fd, 1, 0) > 0 && (fd.revents & POLLIN);
+		}
+
+		// Maximum number of poses in one request
+		std::uint32_t const max_request = 1u << 16;
+	}
+
+	void LatencyHistogram::add(Duration latency)
+	{
+		// Bin 0 is below 1 us, bin k is [2^(k-1), 2^k) us
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+		std::size_t bin = 0;
+		while (us > 0 && bin + 1 < m_bins.size()) {
+			us >>= 1;
+			++bin;
+		}
+		++m_bins[bin];
+		++m_count;
+		m_total += latency;
+	}
+
+	std::size_t LatencyHistogram::count() const
+	{
+		return m_count;
+	}
+
+	void LatencyHistogram::printTo(std::ostream& stream) const
+	{
+		if (m_count == 0) {
+			stream << "Latency: no measurements\n";
+			return;
+		}
+		auto mean = std::chrono::duration<double, std::milli>(m_total).count() / m_count;
+		stream << "Latency of " << m_count << " poses (mean " << std::fixed << std::setprecision(3) << mean << " ms):\n";
+		for (std::size_t bin = 0; bin != m_bins.size(); ++bin) {
+			if (m_bins[bin]) {
+				auto low = bin ? 1ull << (bin - 1) : 0ull;
+				stream << "  [" << std::setw(10) << low << ", " << std::setw(10) << (1ull << bin) << ") us: " << m_bins[bin] << '\n';
+			}
+		}
+	}
+
+	Server::Server(std::string const& filepath, std::string const& socketpath, bool with_opengl, int max_batch)
+		: Application(filepath, "", with_opengl)
+		, m_socketpath(socketpath)
+		, m_max_batch(max_batch)
+		, m_batch(Application::getConfig())
+	{
+		if (max_batch < 1) {
+			throw std::runtime_error("Maximum batch size of the server should be positive");
+		}
+
+		// Synthesize from the first frame of the input views, with a pose trace per batch
+		m_batch.start_frame = 0;
+		m_batch.number_of_frames = 1;
+		m_batch.pose_trace.clear();
+
+		// Replace the socket of a previous server, but no other file
+		struct stat status;
+		if (::lstat(socketpath.c_str(), &status) == 0) {
+			if (!S_ISSOCK(status.st_mode)) {
+				throw std::runtime_error("Cannot listen on " + socketpath + ": the path exists and is not a socket");
+			}
+			if (::unlink(socketpath.c_str()) < 0) {
+				throwSystemError("Failed to remove the previous socket");
+			}
+		}
+		else if (errno != ENOENT) {
+			throwSystemError("Failed to stat the socket path");
+		}
+
+		auto address = socketAddress(socketpath);
+		m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_socket < 0) {
+			throwSystemError("Failed to create socket");
+		}
+		if (::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(m_socket, 1) < 0) {
+			auto error = errno;
+			::close(m_socket);
+			errno = error;
+			throwSystemError("Failed to listen on socket");
+		}
+	}
+
+	Server::~Server()
+	{
+		::close(m_socket);
+		::unlink(m_socketpath.c_str());
+	}
+
+	void Server::serve()
+	{
+		std::cout << "Serving on " << m_socketpath << std::endl;
+		for (bool running = true; running;) {
+			auto connection = ::accept(m_socket, nullptr, nullptr);
+			if (connection < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throwSystemError("Failed to accept a connection");
+			}
+			try {
+				running = serveClient(connection);
+			}
+			catch (std::exception& e) {
+				// A misbehaving client does not stop the server
+				std::cerr << "Client error: " << e.what() << std::endl;
+			}
+			::close(connection);
+			m_connection = -1;
+			m_latencies.printTo(std::cout);
+		}
+	}
+
+	LatencyHistogram const& Server::getLatencies() const
+	{
+		return m_latencies;
+	}
+
+	bool Server::serveClient(int connection)
+	{
+		m_connection = connection;
+		for (;;) {
+			m_batch.pose_trace.clear();
+			m_pending.clear();
+
+			// Block for a request, then add the requests that are already waiting to the batch
+			auto request = readRequest(connection);
+			while (request == Request::poses && m_pending.size() < m_max_batch && isReadable(connection)) {
+				request = readRequest(connection);
+			}
+
+			// Synthesize at most max_batch poses at a time, also when a single request has more poses
+			auto poses = m_batch.pose_trace;
+			for (m_pending_offset = 0; m_pending_offset < m_pending.size(); m_pending_offset += m_max_batch) {
+				auto end = std::min(m_pending.size(), m_pending_offset + m_max_batch);
+				m_batch.pose_trace.assign(poses.begin() + m_pending_offset, poses.begin() + end);
+				m_batch.number_of_output_frames = static_cast<int>(end - m_pending_offset);
+				execute();
+			}
+
+			if (request == Request::disconnected) {
+				return true;
+			}
+			if (request == Request::shut_down) {
+				return false;
+			}
+		}
+	}
+
+	Server::Request Server::readRequest(int connection)
+	{
+		std::uint32_t header[2];
+		if (!receiveAll(connection, header, sizeof(header))) {
+			return Request::disconnected;
+		}
+		if (header[0] != server::request_magic) {
+			throw std::runtime_error("Invalid request");
+		}
+		if (header[1] == 0) {
+			return Request::shut_down;
+		}
+		if (header[1] > max_request) {
+			throw std::runtime_error("Too many poses in one request");
+		}
+
+		auto received = std::chrono::steady_clock::now();
+		for (std::uint32_t i = 0; i != header[1]; ++i) {
+			float pose[6];
+			if (!receiveAll(connection, pose, sizeof(pose))) {
+				throw std::runtime_error("Connection closed in the middle of a request");
+			}
+			m_batch.pose_trace.push_back({ cv::Vec3f(pose[0], pose[1], pose[2]), cv::Vec3f(pose[3], pose[4], pose[5]) });
+			m_pending.push_back({ m_next_pose++, received, 0 });
+		}
+		return Request::poses;
+	}
+
+	Config const& Server::getConfig() const
+	{
+		return m_batch;
+	}
+
+	bool Server::keepInputViews() const
+	{
+		return true;
+	}
+
+	bool Server::wantColor()
+	{
+		return true;
+	}
+
+	bool Server::wantMaskedColor()
+	{
+		return false;
+	}
+
+	bool Server::wantMask()
+	{
+		return false;
+	}
+
+	bool Server::wantDepth()
+	{
+		return false;
+	}
+
+	bool Server::wantMaskedDepth()
+	{
+		return false;
+	}
+
+	void Server::saveColor(cv::Mat3f color, int virtualFrame, int virtualView, Parameters const&)
+	{
+		// Frames of different virtual views may be saved concurrently (ParallelVirtualViews)
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto& pending = m_pending[m_pending_offset + virtualFrame];
+		auto number_of_virtual_views = getConfig().VirtualCameraNames.size();
+
+		server::FrameHeader header;
+		header.magic = server::frame_magic;
+		header.pose = pending.id;
+		header.virtual_view = static_cast<std::uint32_t>(virtualView);
+		header.number_of_virtual_views = static_cast<std::uint32_t>(number_of_virtual_views);
+		header.width = static_cast<std::uint32_t>(color.cols);
+		header.height = static_cast<std::uint32_t>(color.rows);
+		sendAll(m_connection, &header, sizeof(header));
+		for (int row = 0; row != color.rows; ++row) {
+			sendAll(m_connection, color.ptr<cv::Vec3f>(row), color.cols * sizeof(cv::Vec3f));
+		}
+
+		if (++pending.frames_sent == number_of_virtual_views) {
+			m_latencies.add(std::chrono::steady_clock::now() - pending.received);
+		}
+	}
+
+	Client::Client(std::string const& socketpath)
+	{
+		auto address = socketAddress(socketpath);
+		m_socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_socket < 0) {
+			throwSystemError("Failed to create socket");
+		}
+		if (::connect(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+			auto error = errno;
+			::close(m_socket);
+			errno = error;
+			throwSystemError("Failed to connect to the server");
+		}
+	}
+
+	Client::~Client()
+	{
+		::close(m_socket);
+	}
+
+	void Client::request(std::vector<Pose> const& poses)
+	{
+		if (poses.empty() || poses.size() > max_request) {
+			throw std::runtime_error("A request should have between 1 and 65536 poses");
+		}
+		std::vector<float> message;
+		message.reserve(6 * poses.size());
+		for (auto const& pose : poses) {
+			message.insert(message.end(), pose.position.val, pose.position.val + 3);
+			message.insert(message.end(), pose.rotation.val, pose.rotation.val + 3);
+		}
+		std::uint32_t header[2] = { server::request_magic, static_cast<std::uint32_t>(poses.size()) };
+		sendAll(m_socket, header, sizeof(header));
+		sendAll(m_socket, message.data(), message.size() * sizeof(float));
+	}
+
+	cv::Mat3f Client::receive(server::FrameHeader& header)
+	{
+		if (!receiveAll(m_socket, &header, sizeof(header))) {
+			throw std::runtime_error("Server closed the connection");
+		}
+		if (header.magic != server::frame_magic) {
+			throw std::runtime_error("Invalid frame");
+		}
+		cv::Mat3f color(static_cast<int>(header.height), static_cast<int>(header.width));
+		receiveAll(m_socket, color.data, color.total() * sizeof(cv::Vec3f));
+		return color;
+	}
+
+	void Client::shutdown()
+	{
+		std::uint32_t header[2] = { server::request_magic, 0 };
+		sendAll(m_socket, header, sizeof(header));
+	}
+}
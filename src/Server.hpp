@@ -0,0 +1,249 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+#ifndef _SERVER_HPP_
+#define _SERVER_HPP_
+
+#include "Application.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+
+/**
+@file Server.hpp
+\brief The file containing the RVS synthesis server and a client to test it
+
+The server and the client communicate over a Unix domain socket (not available on Windows). All values are in host byte order.
+
+A request consists of:
+	- uint32 request_magic
+	- uint32 number of poses N (0 to shut down the server)
+	- N times six float32: X, Y, Z, Yaw, Pitch, Roll (the fields of a PoseTrace)
+
+For each pose of a request and each virtual camera, the server answers with a frame:
+	- uint32 frame_magic
+	- uint32 pose identifier (counts the poses since the start of the server)
+	- uint32 index of the virtual camera
+	- uint32 number of virtual cameras
+	- uint32 width, uint32 height
+	- width x height x 3 float32: the synthesized color in the working color space (ColorSpace), interleaved, top row first
+
+As with a pose trace, the position of a pose is relative to the position of the virtual camera and the rotation replaces its rotation.
+*/
+
+namespace rvs
+{
+	namespace server
+	{
+		/** First field of a request */
+		std::uint32_t const request_magic = 0x51535652; // "RVSQ"
+
+		/** First field of a frame */
+		std::uint32_t const frame_magic = 0x46535652; // "RVSF"
+
+		/** Header of a frame */
+		struct FrameHeader
+		{
+			std::uint32_t magic;
+			std::uint32_t pose;
+			std::uint32_t virtual_view;
+			std::uint32_t number_of_virtual_views;
+			std::uint32_t width;
+			std::uint32_t height;
+		};
+	}
+
+	/**
+	\brief Histogram of latencies with power-of-two bins in microseconds
+	*/
+	class LatencyHistogram
+	{
+	public:
+		using Duration = std::chrono::steady_clock::duration;
+
+		/** Add a measurement */
+		void add(Duration latency);
+
+		/** @return the number of measurements */
+		std::size_t count() const;
+
+		/** Print the non-empty bins */
+		void printTo(std::ostream& stream) const;
+
+	private:
+		std::array<std::size_t, 32> m_bins{};
+		std::size_t m_count = 0;
+		Duration m_total{};
+	};
+
+	/**
+	\brief The RVS synthesis server
+
+	The server synthesizes the views of the configuration file for the poses that it receives on a Unix domain socket. The input
+	views and their unprojected geometry stay resident (see Pipeline::keepInputViews()), and with OpenGL the shaders are compiled
+	once, such that a request only pays for the warping, blending and inpainting. The first frame of the input views is used.
+
+	Requests that are waiting when the server is ready are batched, and batches are synthesized at most a maximum number of
+	poses at a time, also when a single request has more poses. The latency from
+	receiving a pose to sending its last frame is collected in a histogram.
+	*/
+	class Server : public Application
+	{
+	public:
+		/**
+		\brief Constructor
+		@param filepath Configuration file (JSON format)
+		@param socketpath Path of the Unix domain socket to listen on (a socket that exists is replaced, any other file is an error)
+		@param with_opengl Enable OpenGL acceleration
+		@param max_batch Maximum number of poses to synthesize in one batch
+		*/
+		Server(std::string const& filepath, std::string const& socketpath, bool with_opengl = false, int max_batch = 16);
+
+		/**
+		\brief Destructor, removes the socket
+		*/
+		~Server();
+
+		/**
+		\brief Serve clients, one at a time, until a client requests to shut down
+		*/
+		void serve();
+
+		/**
+		\brief Latencies of all poses so far
+		*/
+		LatencyHistogram const& getLatencies() const;
+
+	protected:
+		Config const& getConfig() const override;
+
+		bool keepInputViews() const override;
+
+		bool wantColor() override;
+		bool wantMaskedColor() override;
+		bool wantMask() override;
+		bool wantDepth() override;
+		bool wantMaskedDepth() override;
+
+		void saveColor(cv::Mat3f color, int virtualFrame, int virtualView, Parameters const& parameters) override;
+
+	private:
+		Server(Server const&) = delete;
+		Server& operator=(Server const&) = delete;
+
+		enum class Request { poses, disconnected, shut_down };
+
+		// Serve one client, returns false on a shut down request
+		bool serveClient(int connection);
+
+		// Read a request and add its poses to the batch
+		Request readRequest(int connection);
+
+		struct PendingPose
+		{
+			std::uint32_t id;
+			std::chrono::steady_clock::time_point received;
+			std::size_t frames_sent;
+		};
+
+		std::string m_socketpath;
+		int m_socket = -1;
+		int m_connection = -1;
+		std::size_t m_max_batch;
+		std::uint32_t m_next_pose = 0;
+		Config m_batch;
+		std::vector<PendingPose> m_pending;
+		std::size_t m_pending_offset = 0; // First pending pose of the batch being synthesized
+		std::mutex m_mutex;
+		LatencyHistogram m_latencies;
+	};
+
+	/**
+	\brief Client of the RVS synthesis server, e.g. for testing
+	*/
+	class Client
+	{
+	public:
+		/**
+		\brief Connect to a server
+		@param socketpath Path of the Unix domain socket of the server
+		*/
+		explicit Client(std::string const& socketpath);
+
+		/**
+		\brief Destructor, disconnects
+		*/
+		~Client();
+
+		/**
+		\brief Request frames for a number of poses
+		*/
+		void request(std::vector<Pose> const& poses);
+
+		/**
+		\brief Receive a frame (blocking)
+		@param header Header of the frame
+		@return Color of the frame
+		*/
+		cv::Mat3f receive(server::FrameHeader& header);
+
+		/**
+		\brief Request the server to shut down
+		*/
+		void shutdown();
+
+	private:
+		Client(Client const&) = delete;
+		Client& operator=(Client const&) = delete;
+
+		int m_socket = -1;
+	};
+}
+
+#endif
@@ -46,12 +46,128 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 #include "Shader.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#if _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace rvs
 {
 	namespace opengl
 	{
+		namespace
+		{
+			// Directory of the program binaries (see ShadersList::setCacheDirectory())
+			std::string g_cache_directory;
+
+			int process_id()
+			{
+#if _WIN32
+				return _getpid();
+#else
+				return static_cast<int>(getpid());
+#endif
+			}
+
+			// FNV-1a, such that the key does not depend on the standard library
+			void hash_append(std::uint64_t& hash, const char* text)
+			{
+				if (text) {
+					for (; *text; ++text) {
+						hash = (hash ^ static_cast<unsigned char>(*text)) * 1099511628211ull;
+					}
+				}
+				hash = hash * 1099511628211ull; // separator
+			}
+
+			bool has_program_binary_formats()
+			{
+				GLint formats = 0;
+				glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+				return formats > 0;
+			}
+		}
+
+		std::string Shader::cache_key(Stages const& stages)
+		{
+			// A binary is only valid for the driver that produced it
+			std::uint64_t hash = 14695981039346656037ull;
+			hash_append(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+			hash_append(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+			hash_append(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+			for (auto const& stage : stages) {
+				hash_append(hash, stage.second.c_str());
+			}
+
+			std::ostringstream stream;
+			stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+			return stream.str();
+		}
+
+		bool Shader::load_program_binary(std::string const& path)
+		{
+			std::ifstream stream(path, std::ios::binary);
+			GLenum format = 0;
+			if (!stream.read(reinterpret_cast<char*>(&format), sizeof(format)) || !has_program_binary_formats()) {
+				return false;
+			}
+			std::vector<char> binary((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+			if (binary.empty()) {
+				return false;
+			}
+
+			// The driver rejects binaries of other versions, in which case the program is compiled from source
+			auto ID = glCreateProgram();
+			glProgramBinary(ID, format, binary.data(), static_cast<GLsizei>(binary.size()));
+			GLint success = 0;
+			glGetProgramiv(ID, GL_LINK_STATUS, &success);
+			if (!success) {
+				glDeleteProgram(ID);
+				return false;
+			}
+			m_ID = ID;
+			return true;
+		}
+
+		void Shader::save_program_binary(std::string const& path) const
+		{
+			GLint length = 0;
+			glGetProgramiv(m_ID, GL_PROGRAM_BINARY_LENGTH, &length);
+			if (length <= 0) {
+				return;
+			}
+			std::vector<char> binary(length);
+			GLenum format = 0;
+			glGetProgramBinary(m_ID, length, &length, &format, binary.data());
+
+			// Write and rename, such that concurrent processes never read a partial file: the temporary file is unique per process
+			// (and per program within a process)
+			auto temporary = path + '.' + std::to_string(process_id()) + '.' + std::to_string(m_ID) + ".tmp";
+			{
+				std::ofstream stream(temporary, std::ios::binary);
+				stream.write(reinterpret_cast<const char*>(&format), sizeof(format));
+				stream.write(binary.data(), length);
+				if (!stream) {
+					printf("| WARNING::SHADER: Failed to write %s\n", temporary.c_str());
+					return;
+				}
+			}
+			if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+				std::remove(temporary.c_str());
+			}
+		}
+
 		void Shader::shader_compile_errors(const GLuint &object, const char * type) {
 			std::string type_(type);
 			GLint success;
@@ -123,32 +239,67 @@ namespace rvs
 			return id;
 		}
 
-		Shader::Shader(std::string vertexSource, std::string fragmentSource, std::string geometrySource)
+		Shader::Shader(std::string vertexSource, std::string fragmentSource, std::string geometrySource, std::string const& cacheDirectory)
 			: m_ID(0)
 		{
-			// Compile shaders
 			assert(!vertexSource.empty() && !fragmentSource.empty());
-			auto vertexShader = compile_shader(vertexSource, GL_VERTEX_SHADER);
-			auto fragmentShader = compile_shader(fragmentSource, GL_FRAGMENT_SHADER);
-			auto geometryShader = geometrySource.empty() ? GLuint(0) : compile_shader(geometrySource, GL_GEOMETRY_SHADER);
 
-			// Attach shaders to a new program
+			Stages stages = {
+				{ GL_VERTEX_SHADER, vertexSource },
+				{ GL_FRAGMENT_SHADER, fragmentSource },
+				{ GL_GEOMETRY_SHADER, geometrySource } };
+			build(stages, cacheDirectory);
+		}
+
+		Shader Shader::compute(std::string computeSource, std::string const& cacheDirectory)
+		{
+			assert(!computeSource.empty());
+
+			Shader shader;
+			shader.build(Stages{ { GL_COMPUTE_SHADER, computeSource } }, cacheDirectory);
+			return shader;
+		}
+
+		void Shader::build(Stages const& stages, std::string const& cacheDirectory)
+		{
+			// Load the program binary from the cache
+			auto cacheFile = cacheDirectory.empty()
+				? std::string()
+				: cacheDirectory + '/' + cache_key(stages) + ".bin";
+			if (!cacheFile.empty() && load_program_binary(cacheFile)) {
+				printf("PROGRAM WITH ID: %i FROM %s\n", m_ID, cacheFile.c_str());
+				resolve_uniforms();
+				return;
+			}
+
+			// Compile the (non-empty) shaders and attach them to a new program
 			auto ID = glCreateProgram();
-			glAttachShader(ID, vertexShader);
-			glAttachShader(ID, fragmentShader);
-			if (geometryShader) {
-				glAttachShader(ID, geometryShader);
+			std::vector<GLuint> shaders;
+			for (auto const& stage : stages) {
+				if (!stage.second.empty()) {
+					shaders.push_back(compile_shader(stage.second, stage.first));
+					glAttachShader(ID, shaders.back());
+				}
+			}
+			if (!cacheFile.empty()) {
+				glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 			}
 			glLinkProgram(ID);
 			shader_compile_errors(ID, "Program");
 			m_ID = ID;
 			printf("NEW PROGRAM WITH ID: %i\n", m_ID);
+			resolve_uniforms();
+
+			// Store the program binary in the cache
+			GLint success = 0;
+			glGetProgramiv(ID, GL_LINK_STATUS, &success);
+			if (!cacheFile.empty() && success && has_program_binary_formats()) {
+				save_program_binary(cacheFile);
+			}
 
 			// Delete the shaders as they're linked into our ID now and no longer necessery
-			glDeleteShader(vertexShader);
-			glDeleteShader(fragmentShader);
-			if (geometryShader) {
-				glDeleteShader(geometryShader);
+			for (auto shader : shaders) {
+				glDeleteShader(shader);
 			}
 		}
 
@@ -157,29 +308,92 @@ namespace rvs
 			return m_ID;
 		}
 
+		GLint Shader::uniform(const char* name) const
+		{
+			auto it = m_uniforms.find(name);
+			return it == m_uniforms.end() ? -1 : it->second;
+		}
+
+		void Shader::resolve_uniforms()
+		{
+			GLint count = 0;
+			GLint max_length = 0;
+			glGetProgramiv(m_ID, GL_ACTIVE_UNIFORMS, &count);
+			glGetProgramiv(m_ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+			std::vector<GLchar> name(std::max(max_length, 1));
+			for (GLint i = 0; i < count; ++i) {
+				GLint size;
+				GLenum type;
+				GLsizei length = 0;
+				glGetActiveUniform(m_ID, GLuint(i), GLsizei(name.size()), &length, &size, &type, name.data());
+
+				// Members of uniform blocks have no location
+				auto location = glGetUniformLocation(m_ID, name.data());
+				if (location >= 0) {
+					m_uniforms[std::string(name.data(), length)] = location;
+				}
+			}
+		}
+
 		ShadersList::ShadersList()
 			: m_shaders({
 				{ "synthesis", Shader(
 					getSynthesisVertexShaderSource(),
 					getSynthesisFragmentShaderSource(),
-					getSynthesisGeometryShaderSource())
+					getSynthesisGeometryShaderSource(),
+					g_cache_directory)
 				},
 				{ "synthesis_polynomial", Shader(
 					getSynthesisVertexShaderSourcePolynomial(),
 					getSynthesisFragmentShaderSource(),
-					getSynthesisGeometryShaderSource())
+					getSynthesisGeometryShaderSource(),
+					g_cache_directory)
 				},
 				{ "blending1", Shader(
 					getBlendingVertexShaderSource(),
-					getBlendingFragmentShaderSource(1))
+					getBlendingFragmentShaderSource(1),
+					std::string(),
+					g_cache_directory)
 				},
 				{ "blending2", Shader(
 					getBlendingVertexShaderSource(),
-					getBlendingFragmentShaderSource(2))
+					getBlendingFragmentShaderSource(2),
+					std::string(),
+					g_cache_directory)
+				},
+				{ "synthesis_layered", Shader(
+					getSynthesisVertexShaderSourceLayered(),
+					getSynthesisFragmentShaderSourceLayered(),
+					getSynthesisGeometryShaderSourceLayered(),
+					g_cache_directory)
+				},
+				{ "blending_layered", Shader(
+					getBlendingVertexShaderSource(),
+					getLayeredBlendingFragmentShaderSource(),
+					std::string(),
+					g_cache_directory)
+				},
+				{ "inpaint_seed", Shader::compute(
+					getInpaintSeedComputeShaderSource(),
+					g_cache_directory)
+				},
+				{ "inpaint_jump", Shader::compute(
+					getInpaintJumpComputeShaderSource(),
+					g_cache_directory)
+				},
+				{ "inpaint_output", Shader::compute(
+					getInpaintOutputComputeShaderSource(),
+					g_cache_directory)
 				}
 				})
 		{}
 
+		void ShadersList::setCacheDirectory(std::string const& directory)
+		{
+			g_cache_directory = directory;
+		}
+
 		ShadersList const& ShadersList::getInstance()
 		{
 			static ShadersList singleton;
@@ -191,57 +405,125 @@ namespace rvs
 			return m_shaders.at(name);
 		}
 
-		std::string ShadersList::getSynthesisVertexShaderSource()
+		std::string ShadersList::getViewParametersMembersSource()
 		{
+			// std140 layout, see ViewParameters
 			return R"(
-		#version 420 core
+			// Rotation and translation
+			mat3 R;
+			vec3 t;
+
+			// Input and output sizes
+			float w;
+			float h;
+			float n_w;
+			float n_h;
+
+			float max_depth;
+
+			// Perspective unprojection and projection
+			vec2 f;
+			vec2 p;
+			vec2 n_f;
+			vec2 n_p;
+
+			// Input/output projection types
+			int erp_in;
+			int erp_out;
+
+			// Equirectangular unprojection
+			float phi0;
+			float theta0;
+			float dphi_du;
+			float dtheta_dv;
+
+			// Equirectangular projection
+			float u0;
+			float v0;
+			float du_dphi;
+			float dv_dtheta;
+
+			// Blending
+			float input_distance;
+	)";
+		}
 
-		layout(location = 0) in float empty_value;
-		uniform sampler2D depth_texture;
+		std::string ShadersList::getViewParametersBlockSource()
+		{
+			return R"(
+		layout(std140, binding = 0) uniform ViewParameters {
+	)" + getViewParametersMembersSource() + R"(
+		};
+	)";
+		}
 
-		out VS_OUT {
-			vec2 uv;
-			float depth;
-			vec3 pos_in; //for normal computation
-			vec3 pos_out; //for normal computation
-		} vs_out;
+		std::string ShadersList::getBatchedViewParametersBlockSource(std::string const& layer)
+		{
+			auto source = std::string(R"(
+		struct LayerParameters {
+	)") + getViewParametersMembersSource() + R"(
+		};
+
+		layout(std140, binding = 1) uniform BatchedViewParameters {
+			LayerParameters views[)" + std::to_string(BatchedViewParameters::max_views) + R"(];
+		};
+	)";
 
-		uniform float w;
-		uniform float h;
-		uniform float n_w;
-		uniform float n_h;
-		uniform float sensor;
+			// The parameters of the layer under the names of the ViewParameters block, such that the shader bodies are shared
+			const char* names[] = { "R", "t", "w", "h", "n_w", "n_h", "max_depth", "f", "p", "n_f", "n_p", "erp_in", "erp_out",
+				"phi0", "theta0", "dphi_du", "dtheta_dv", "u0", "v0", "du_dphi", "dv_dtheta", "input_distance" };
+			for (auto name : names) {
+				source += std::string("\t\t#define ") + name + " views[" + layer + "]." + name + '\n';
+			}
+			return source;
+		}
 
+		std::string ShadersList::getSynthesisVertexShaderSource()
+		{
+			return std::string(R"(
+		#version 420 core
 
-		// Rotation and translation
-		uniform mat3 R;
-		uniform vec3 t;
+		layout(location = 0) in float empty_value;
+		uniform sampler2D depth_texture;
+	)") + getViewParametersBlockSource() + R"(
+		float input_depth(vec2 uv) {
+			return texture(depth_texture, uv).x;
+		}
 
-		// Input/output projection types
-		uniform int erp_in;
-		uniform int erp_out;
+		void set_layer() {}
+	)" + getSynthesisVertexShaderBody();
+		}
 
-		// Perspective unprojection
-		uniform vec2 f;
-		uniform vec2 p;
+		std::string ShadersList::getSynthesisVertexShaderSourceLayered()
+		{
+			return std::string(R"(
+		#version 420 core
 
-		// Perspective projection
-		uniform vec2 n_f;
-		uniform vec2 n_p;
+		// One instance per input view, which is warped into the layer with the same index
+		layout(location = 0) in float empty_value;
+		uniform sampler2DArray depth_textures;
 
-		// Equirectangular unprojection
-		uniform float phi0;
-		uniform float theta0;
-		uniform float dphi_du;
-		uniform float dtheta_dv;
+		flat out int vs_layer;
+	)") + getBatchedViewParametersBlockSource("gl_InstanceID") + R"(
+		float input_depth(vec2 uv) {
+			return texture(depth_textures, vec3(uv, gl_InstanceID)).x;
+		}
 
-		// Equirectangular projection
-		uniform float u0;
-		uniform float v0;
-		uniform float du_dphi;
-		uniform float dv_dtheta;
+		void set_layer() {
+			vs_layer = gl_InstanceID;
+		}
+	)" + getSynthesisVertexShaderBody();
+		}
 
-		uniform float max_depth;
+		std::string ShadersList::getSynthesisVertexShaderBody()
+		{
+			return R"(
+		out VS_OUT {
+			vec2 uv;
+			float depth;
+			vec3 pos_in; //for normal computation
+			vec3 pos_out; //for normal computation
+		} vs_out;
 
 		vec2 get_position_from_Vertex_ID(int id, float width) {
 			int y = id / int(width);
@@ -252,7 +534,7 @@ namespace rvs
 		vec3 unproject_equirectangular() {
 			// Image coordinates
 			vec2 xy = get_position_from_Vertex_ID(gl_VertexID, w);
-			float d = texture(depth_texture, vec2(xy.x/w, xy.y/h)).x*max_depth;
+			float d = input_depth(vec2(xy.x/w, xy.y/h))*max_depth;
 
 			// Spherical coordinates
 			float phi = phi0 + xy.x * dphi_du;
@@ -267,7 +549,7 @@ namespace rvs
 		vec3 unproject_perspective() {
 			// Image coordinates
 			vec2 xy = get_position_from_Vertex_ID(gl_VertexID, w);
-			float d = texture(depth_texture, vec2(xy.x/w, xy.y/h)).x*max_depth;
+			float d = input_depth(vec2(xy.x/w, xy.y/h))*max_depth;
 
 			// World coordinates
 			return vec3(
@@ -312,7 +594,7 @@ namespace rvs
 
 			// Image coordinates (in [-1, 1])
 			if(r.x > 0){
-				gl_Position = vec4(2.0*uv.x/n_w-1.0, -2.0*uv.y/n_h+1.0, 1.f, 1.f);
+				gl_Position = vec4(2.0*uv.x/n_w-1.0, -2.0*uv.y/n_h+1.0, 1.0, 1.0);
 			}
 			else {
 				gl_Position = vec4(
@@ -326,6 +608,7 @@ namespace rvs
 		void main(void)
 		{
 			vec3 eucl;
+			set_layer();
 
 			if (erp_in == 1)
 				eucl = unproject_equirectangular();
@@ -346,12 +629,36 @@ namespace rvs
 
 		std::string ShadersList::getSynthesisFragmentShaderSource()
 		{
-			return R"(
+			return std::string(R"(
 		#version 420 core
 
 		uniform sampler2D image_texture;
 		uniform sampler2D depth_texture;
+	)") + getViewParametersBlockSource() + R"(
+		vec3 input_color(vec2 uv) {
+			return texture(image_texture, uv).rgb;
+		}
+	)" + getSynthesisFragmentShaderBody();
+		}
+
+		std::string ShadersList::getSynthesisFragmentShaderSourceLayered()
+		{
+			return std::string(R"(
+		#version 420 core
+
+		uniform sampler2DArray image_textures;
 
+		flat in int gs_layer;
+	)") + getBatchedViewParametersBlockSource("gs_layer") + R"(
+		vec3 input_color(vec2 uv) {
+			return texture(image_textures, vec3(uv, gs_layer)).rgb;
+		}
+	)" + getSynthesisFragmentShaderBody();
+		}
+
+		std::string ShadersList::getSynthesisFragmentShaderBody()
+		{
+			return R"(
 		in vec2 gs_uv;
 		in float gs_quality;
 		in float gs_depth;
@@ -360,11 +667,9 @@ namespace rvs
 		layout(location=1) out float depth;
 		layout(location=2) out float quality;
 
-		uniform float max_depth;
-
 		void main(void)
 		{
-			color = texture(image_texture, gs_uv).rgb;
+			color = input_color(gs_uv);
 			//depth = gs_depth/max_depth/1000.0;//*100.0;
 			//quality = 0.01*gs_quality/depth/depth/depth; //version lambertien
 			depth = gs_depth/max_depth;
@@ -389,12 +694,37 @@ namespace rvs
 
 		std::string ShadersList::getSynthesisGeometryShaderSource()
 		{
-			return R"(
+			return std::string(R"(
+		#version 420 core
+
+		layout(triangles) in;
+		layout(triangle_strip, max_vertices = 3) out;
+	)") + getViewParametersBlockSource() + R"(
+		void set_layer() {}
+	)" + getSynthesisGeometryShaderBody();
+		}
+
+		std::string ShadersList::getSynthesisGeometryShaderSourceLayered()
+		{
+			return std::string(R"(
 		#version 420 core
 
 		layout(triangles) in;
 		layout(triangle_strip, max_vertices = 3) out;
 
+		flat in int vs_layer[];
+		flat out int gs_layer;
+	)") + getBatchedViewParametersBlockSource("vs_layer[0]") + R"(
+		void set_layer() {
+			gl_Layer = vs_layer[0];
+			gs_layer = vs_layer[0];
+		}
+	)" + getSynthesisGeometryShaderBody();
+		}
+
+		std::string ShadersList::getSynthesisGeometryShaderBody()
+		{
+			return R"(
 		in VS_OUT {
 			vec2 uv;
 			float depth;
@@ -406,9 +736,6 @@ namespace rvs
 		out float gs_quality;
 		out float gs_depth;
 
-		uniform float w;
-		uniform float h;
-		uniform float max_depth;
 		uniform float min_depth;
 
 		float get_quality() { 
@@ -420,7 +747,13 @@ namespace rvs
 			float dac = length(A - C)/2.0;
 			float dbc = length(B - C)/2.0;
 
-			float stretch = max(dbc, max(dab, dac));
+			// Relative to the shortest edge in input pixels, for the larger triangles of the mesh decimation
+			vec2 a = gs_in[0].uv * vec2(w, h);
+			vec2 b = gs_in[1].uv * vec2(w, h);
+			vec2 c = gs_in[2].uv * vec2(w, h);
+			float scale = max(1.0, min(length(b - c), min(length(a - b), length(a - c))));
+
+			float stretch = max(dbc, max(dab, dac)) / scale;
 
 			float quality = max(0.0,15.0 - stretch);
 			return quality;
@@ -445,6 +778,7 @@ namespace rvs
 				gs_depth = d_max;
 			}
 			gl_Position = gl_in[index].gl_Position;
+			set_layer();
 			EmitVertex();
 		}
 
@@ -557,9 +891,188 @@ namespace rvs
 
 	)";
 		}
-		std::string ShadersList::getSynthesisVertexShaderSourcePolynomial()
+		std::string ShadersList::getLayeredBlendingFragmentShaderSource()
+		{
+			return std::string(R"(
+		#version 420 core
+		layout(location=0) out vec4 color;
+		layout(location=1) out float quality;
+
+		uniform sampler2DArray layered_image;
+		uniform sampler2DArray layered_depth;
+		uniform sampler2DArray layered_quality;
+
+		uniform int number_of_views;
+		uniform float blending_factor;
+	)") + getBatchedViewParametersBlockSource("i") + R"(
+		in vec2 vs_position;
+
+		// The weights of the blending passes, accumulated over all layers at once. With blending_factor <= 0.5
+		// the passes average the new view with the accumulator at equal weight, so the layers are folded in
+		// the same order here to give the same result.
+		void main(void)
+		{
+			vec4 sum_color = vec4(0.0);
+			float sum_w = 0.0;
+
+			for (int i = 0; i < number_of_views; ++i) {
+				vec3 position = vec3(vs_position, float(i));
+				float n_triangle_quality = texture(layered_quality, position).x;
+				float n_depth = texture(layered_depth, position).x;
+				if (n_depth == 0.0 || n_triangle_quality == 0.0)
+					continue;
+
+				vec4 n_color = texture(layered_image, position);
+				if (blending_factor > 0.5) {
+					float new_w = pow(n_triangle_quality/n_depth/input_distance, blending_factor);
+					sum_color += new_w*n_color;
+					sum_w += new_w;
+				}
+				else if (sum_w > 0.0) {
+					sum_color = (sum_color + n_color)/2.0;
+					sum_w = 2.0;
+				}
+				else {
+					sum_color = n_color;
+					sum_w = 1.0;
+				}
+			}
+
+			if (blending_factor > 0.5) {
+				color = sum_w > 0.0 ? sum_color/sum_w : vec4(0.0);
+				quality = sum_w > 0.0 ? pow(sum_w, 1.0/blending_factor) : 0.0;
+			}
+			else {
+				color = sum_color;
+				quality = sum_w;
+			}
+		}
+	)";
+		}
+
+		std::string ShadersList::getInpaintSeedComputeShaderSource()
+		{
+			return R"(
+		#version 430 core
+		layout(local_size_x = 16, local_size_y = 16) in;
+
+		uniform sampler2D blended_quality;
+		layout(rg32i, binding = 0) writeonly uniform iimage2D seeds;
+
+		// The known pixels are their own nearest known pixel, the others have none yet (see View::get_inpaint_mask())
+		void main(void)
+		{
+			ivec2 position = ivec2(gl_GlobalInvocationID.xy);
+			if (any(greaterThanEqual(position, imageSize(seeds))))
+				return;
+
+			bool known = texelFetch(blended_quality, position, 0).x > 0.0;
+			imageStore(seeds, position, known ? ivec4(position, 0, 0) : ivec4(-1));
+		}
+	)";
+		}
+
+		std::string ShadersList::getInpaintJumpComputeShaderSource()
 		{
 			return R"(
+		#version 430 core
+		layout(local_size_x = 16, local_size_y = 16) in;
+
+		layout(rg32i, binding = 0) readonly uniform iimage2D seeds_in;
+		layout(rg32i, binding = 1) writeonly uniform iimage2D seeds_out;
+		uniform int step_length;
+
+		// One pass of jump flooding: keep the nearest of the known pixels found by the neighbours at step_length. The distance
+		// is the city block distance of the nearest pixel inpainting on the CPU (see detail::inpaint())
+		void main(void)
+		{
+			ivec2 position = ivec2(gl_GlobalInvocationID.xy);
+			ivec2 size = imageSize(seeds_in);
+			if (any(greaterThanEqual(position, size)))
+				return;
+
+			ivec2 best = imageLoad(seeds_in, position).xy;
+			int best_distance = best.x < 0 ? 0x7fffffff : 0;
+			for (int dy = -1; dy <= 1; ++dy) {
+				for (int dx = -1; dx <= 1; ++dx) {
+					ivec2 neighbour = position + step_length*ivec2(dx, dy);
+					if (any(lessThan(neighbour, ivec2(0))) || any(greaterThanEqual(neighbour, size)))
+						continue;
+
+					ivec2 seed = imageLoad(seeds_in, neighbour).xy;
+					if (seed.x < 0)
+						continue;
+
+					ivec2 offset = abs(seed - position);
+					int distance = offset.x + offset.y;
+					if (distance < best_distance) {
+						best = seed;
+						best_distance = distance;
+					}
+				}
+			}
+			imageStore(seeds_out, position, ivec4(best, 0, 0));
+		}
+	)";
+		}
+
+		std::string ShadersList::getInpaintOutputComputeShaderSource()
+		{
+			return R"(
+		#version 430 core
+		layout(local_size_x = 16, local_size_y = 16) in;
+
+		uniform sampler2D blended_image;
+		uniform sampler2D blended_quality;
+		uniform float validity_threshold;
+		layout(rg32i, binding = 0) readonly uniform iimage2D seeds;
+		layout(rgba32f, binding = 1) writeonly uniform image2D output_color;
+		layout(r8, binding = 2) writeonly uniform image2D output_mask;
+
+		ivec2 size;
+
+		// OpenCV stores the rows top-down
+		ivec2 flip(ivec2 position)
+		{
+			return ivec2(position.x, size.y - 1 - position.y);
+		}
+
+		vec3 inpainted(ivec2 position)
+		{
+			ivec2 seed = imageLoad(seeds, flip(position)).xy;
+			return texelFetch(blended_image, seed.x < 0 ? flip(position) : seed, 0).rgb;
+		}
+
+		// Inpainting, downscaling (bilinear as cv::resize) and the validity mask (see View::get_validity_mask()) of one output pixel
+		void main(void)
+		{
+			ivec2 position = ivec2(gl_GlobalInvocationID.xy);
+			ivec2 output_size = imageSize(output_color);
+			if (any(greaterThanEqual(position, output_size)))
+				return;
+
+			size = textureSize(blended_image, 0);
+			vec2 scale = vec2(size)/vec2(output_size);
+
+			vec2 source = clamp((vec2(position) + 0.5)*scale - 0.5, vec2(0.0), vec2(size - 1));
+			ivec2 p0 = ivec2(source);
+			ivec2 p1 = min(p0 + 1, size - 1);
+			vec2 a = source - vec2(p0);
+			vec3 color = mix(
+				mix(inpainted(p0), inpainted(ivec2(p1.x, p0.y)), a.x),
+				mix(inpainted(ivec2(p0.x, p1.y)), inpainted(p1), a.x), a.y);
+			imageStore(output_color, position, vec4(color, 1.0));
+
+			ivec2 nearest = min(ivec2(vec2(position)*scale), size - 1);
+			bool valid = texelFetch(blended_quality, flip(nearest), 0).x > validity_threshold;
+			imageStore(output_mask, position, vec4(valid ? 0.0 : 1.0));
+		}
+	)";
+		}
+
+		std::string ShadersList::getSynthesisVertexShaderSourcePolynomial()
+		{
+			return std::string(R"(
 		#version 420 core
 
 		layout(location = 0) in float empty_value;
@@ -579,31 +1092,7 @@ namespace rvs
 			vec3 pos_out; //for normal computation
 		} vs_out;
 
-		uniform float w;
-		uniform float h;
-		uniform float n_w;
-		uniform float n_h;
-		uniform float sensor;
-
-
-		// Rotation and translation
-		uniform mat3 R;
-		uniform vec3 t;
-
-		// Input/output projection types 0 perspective, 1 erp, 2 Xslit
-		uniform int erp_in;
-		uniform int erp_out;
-
-		// Perspective unprojection
-		uniform vec2 f;
-		uniform vec2 p;
-
-		// Perspective projection
-		uniform vec2 n_f;
-		uniform vec2 n_p;
-
-
-		uniform float max_depth;
+	)") + getViewParametersBlockSource() + R"(
 
 		vec2 get_position_from_Vertex_ID(int id, float width) {
 			int y = id / int(width);
@@ -57,24 +57,103 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "helpersGL.hpp"
 
 #include <map>
+#include <utility>
+#include <vector>
 
 namespace rvs
 {
 	namespace opengl 
 	{
+		/**
+		\brief Per-view parameters of the synthesis programs
+
+		Mirrors the std140 layout of the ViewParameters uniform block (see ShadersList::getViewParametersBlockSource()), and is
+		uploaded once per draw with ResourceCache::uniform_buffer().
+		*/
+		struct ViewParameters
+		{
+			/** Binding point of the uniform block */
+			static GLuint const binding = 0;
+
+			GLfloat R[3][4]; // mat3: the columns are padded to vec4
+			GLfloat t[3];
+			GLfloat w;
+			GLfloat h;
+			GLfloat n_w;
+			GLfloat n_h;
+			GLfloat max_depth;
+			GLfloat f[2];
+			GLfloat p[2];
+			GLfloat n_f[2];
+			GLfloat n_p[2];
+			GLint erp_in;
+			GLint erp_out;
+			GLfloat phi0;
+			GLfloat theta0;
+			GLfloat dphi_du;
+			GLfloat dtheta_dv;
+			GLfloat u0;
+			GLfloat v0;
+			GLfloat du_dphi;
+			GLfloat dv_dtheta;
+			GLfloat input_distance;
+			GLfloat padding;
+		};
+		static_assert(sizeof(ViewParameters) == 160, "ViewParameters does not match the std140 layout");
+
+		/**
+		\brief Per-view parameters of all input views of a batched synthesis (see synthesize_batched())
+
+		Mirrors the std140 layout of the BatchedViewParameters uniform block: an array of ViewParameters, indexed by layer.
+		*/
+		struct BatchedViewParameters
+		{
+			/** Binding point of the uniform block */
+			static GLuint const binding = 1;
+
+			/** Maximum number of input views of a batch */
+			static int const max_views = 16;
+
+			ViewParameters views[max_views];
+		};
+
 		class Shader
 		{
 		public:
-			Shader(std::string vertexSource, std::string fragmentSource, std::string geometrySource = std::string());
+			/**
+			\brief Compile and link a program, or load it from the cache directory (if not empty)
+
+			The program binaries are keyed by driver and shader sources. When a binary is missing or rejected by the driver, the
+			program is compiled from source and its binary is stored.
+			*/
+			Shader(std::string vertexSource, std::string fragmentSource, std::string geometrySource = std::string(), std::string const& cacheDirectory = std::string());
+
+			/**
+			\brief Compile and link a compute program, or load it from the cache directory (if not empty)
+			*/
+			static Shader compute(std::string computeSource, std::string const& cacheDirectory = std::string());
 
 			GLuint getProgramID() const;
 
+			/** Location of a uniform of the default block, resolved once after linking (-1 if it is not active) */
+			GLint uniform(const char* name) const;
+
 		private:
+			// Shader type and source of each stage (empty: no such stage)
+			typedef std::vector<std::pair<GLenum, std::string>> Stages;
+
+			Shader() {}
+			void build(Stages const& stages, std::string const& cacheDirectory);
+			void resolve_uniforms();
+			static std::string cache_key(Stages const& stages);
+			bool load_program_binary(std::string const& path);
+			void save_program_binary(std::string const& path) const;
 			static void shader_compile_errors(const GLuint &object, const char * type);
 			static const char * shader_type2string(GLenum shaderType);
 			static GLuint compile_shader(const std::string shader, GLenum shaderType);
 
 			GLuint m_ID = 0;
+			std::map<std::string, GLint> m_uniforms;
 		};
 
 		class ShadersList
@@ -82,17 +161,37 @@ namespace rvs
 		public:
 			static ShadersList const& getInstance();
 
+			/**
+			\brief Cache the program binaries in an existing directory (empty: no cache)
+
+			Only effective before the first call to getInstance().
+			*/
+			static void setCacheDirectory(std::string const& directory);
+
 			Shader const& operator () (const char* name) const;
 
 		private:
 			ShadersList();
 
+			std::string getViewParametersMembersSource();
+			std::string getViewParametersBlockSource();
+			std::string getBatchedViewParametersBlockSource(std::string const& layer);
+			std::string getSynthesisVertexShaderBody();
 			std::string getSynthesisVertexShaderSource();
+			std::string getSynthesisVertexShaderSourceLayered();
 			std::string getSynthesisVertexShaderSourcePolynomial();
+			std::string getSynthesisFragmentShaderBody();
 			std::string getSynthesisFragmentShaderSource();
+			std::string getSynthesisFragmentShaderSourceLayered();
+			std::string getSynthesisGeometryShaderBody();
 			std::string getSynthesisGeometryShaderSource();
+			std::string getSynthesisGeometryShaderSourceLayered();
 			std::string getBlendingVertexShaderSource();
 			std::string getBlendingFragmentShaderSource(int step);
+			std::string getLayeredBlendingFragmentShaderSource();
+			std::string getInpaintSeedComputeShaderSource();
+			std::string getInpaintJumpComputeShaderSource();
+			std::string getInpaintOutputComputeShaderSource();
 
 			std::map<std::string, Shader> m_shaders;
 		};
@@ -54,6 +54,81 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 namespace rvs
 {
+	namespace
+	{
+		void throwUnknownProjectionType(Parameters const& parameters)
+		{
+			std::ostringstream what;
+			what << "Unknown projection type \"" << parameters.getProjectionType() << "\"";
+			throw std::runtime_error(what.str());
+		}
+
+		std::unique_ptr<Unprojector> createUnprojector(Parameters const& parameters)
+		{
+			if (parameters.getProjectionType() == ProjectionType::equirectangular) {
+				return std::unique_ptr<Unprojector>(new EquirectangularUnprojector(parameters));
+			}
+			if (parameters.getProjectionType() != ProjectionType::perspective) {
+				throwUnknownProjectionType(parameters);
+			}
+			return std::unique_ptr<Unprojector>(new PerspectiveUnprojector(parameters));
+		}
+
+		std::unique_ptr<Projector> createProjector(Parameters const& parameters)
+		{
+			if (parameters.getProjectionType() == ProjectionType::equirectangular) {
+				return std::unique_ptr<Projector>(new EquirectangularProjector(parameters));
+			}
+			if (parameters.getProjectionType() != ProjectionType::perspective) {
+				throwUnknownProjectionType(parameters);
+			}
+			return std::unique_ptr<Projector>(new PerspectiveProjector(parameters));
+		}
+
+		// Fused unproject, x -> Rx + t and project with scaling to the output size
+		template<class Unprojection, class Projection>
+		cv::Mat2f warp_kernel(Unprojection unprojection, Projection projection, cv::Matx33f R, cv::Vec3f t, cv::Vec2f scale,
+			cv::Mat2f input_uv, cv::Mat1f input_depth, /*in,out*/ cv::Mat3f& world_pos, /*out*/ cv::Mat1f& depth)
+		{
+			auto image_pos = cv::Mat2f(input_uv.empty() ? world_pos.size() : input_uv.size());
+			depth = cv::Mat1f(image_pos.size());
+
+			if (input_uv.empty()) {
+#pragma omp parallel for
+				for (int i = 0; i < image_pos.rows; ++i) {
+					for (int j = 0; j < image_pos.cols; ++j) {
+						auto uv = projection(R * world_pos(i, j) + t, depth(i, j));
+						image_pos(i, j) = cv::Vec2f(scale[0] * uv[0], scale[1] * uv[1]);
+					}
+				}
+			}
+			else {
+				world_pos = cv::Mat3f(image_pos.size());
+#pragma omp parallel for
+				for (int i = 0; i < image_pos.rows; ++i) {
+					for (int j = 0; j < image_pos.cols; ++j) {
+						auto xyz = unprojection(input_uv(i, j), input_depth(i, j));
+						world_pos(i, j) = xyz;
+						auto uv = projection(R * xyz + t, depth(i, j));
+						image_pos(i, j) = cv::Vec2f(scale[0] * uv[0], scale[1] * uv[1]);
+					}
+				}
+			}
+
+			return image_pos;
+		}
+
+		template<class Unprojection>
+		cv::Mat2f warp_kernel(Unprojection unprojection, Parameters const& virtual_parameters, cv::Matx33f R, cv::Vec3f t, cv::Vec2f scale,
+			cv::Mat2f input_uv, cv::Mat1f input_depth, /*in,out*/ cv::Mat3f& world_pos, /*out*/ cv::Mat1f& depth)
+		{
+			if (virtual_parameters.getProjectionType() == ProjectionType::equirectangular) {
+				return warp_kernel(unprojection, EquirectangularProjector::Kernel(virtual_parameters), R, t, scale, input_uv, input_depth, world_pos, depth);
+			}
+			return warp_kernel(unprojection, PerspectiveProjector::Kernel(virtual_parameters), R, t, scale, input_uv, input_depth, world_pos, depth);
+		}
+	}
+
 	SpaceTransformer::SpaceTransformer()
 		: m_input_parameters(nullptr)
 		, m_output_parameters(nullptr)
@@ -109,40 +184,73 @@ namespace rvs
 		return m_unprojector->unproject(image_pos, depth);
 	}
 
-	void GenericTransformer::set_inputPosition(Parameters const *parameters)
+	cv::Mat2f GenericTransformer::reproject(cv::Mat2f virtual_image_pos, cv::Mat1f virtual_depth) const
 	{
-		assert(parameters);
-		SpaceTransformer::set_inputPosition(parameters);
+		// Virtual view image to virtual view world coordinates
+		auto virtual_xyz = m_virtual_unprojector->unproject(virtual_image_pos, virtual_depth);
 
-		if (parameters->getProjectionType() == ProjectionType::equirectangular) {
-			m_unprojector.reset(new EquirectangularUnprojector(*parameters));
+		// Inverse of the affine transformation x -> Rx + t from input to virtual view
+		auto R = get_rotation();
+		auto t = get_translation();
+		auto input_xyz = cv::Mat3f(virtual_xyz.size());
+#pragma omp parallel for
+		for (int i = 0; i < input_xyz.rows; ++i) {
+			for (int j = 0; j < input_xyz.cols; ++j) {
+				input_xyz(i, j) = R.t() * (virtual_xyz(i, j) - t);
+			}
 		}
-		else if (parameters->getProjectionType() == ProjectionType::perspective) {
-			m_unprojector.reset(new PerspectiveUnprojector(*parameters));
+
+		// Input view world to input view image coordinates
+		cv::Mat1f input_depth;
+		WrappingMethod wrapping_method;
+		return m_input_projector->project(input_xyz, input_depth, wrapping_method);
+	}
+
+	cv::Mat2f GenericTransformer::warp(cv::Mat1f input_depth, cv::Size output_size, /*in,out*/ cv::Mat3f& world_pos, /*out*/ cv::Mat1f& depth, /*out*/ WrappingMethod& wrapping_method) const
+	{
+		auto const& input_parameters = getInputParameters();
+		auto const& virtual_parameters = getVirtualParameters();
+		auto virtual_size = virtual_parameters.getSize();
+		auto scale = cv::Vec2f(
+			float(output_size.width) / virtual_size.width,
+			float(output_size.height) / virtual_size.height);
+
+		// Image positions are only needed when the world positions are not known yet
+		cv::Mat2f input_uv;
+		if (world_pos.empty()) {
+			input_uv = m_unprojector->generateImagePos();
+		}
+
+		// Select the specialised kernel once per view
+		cv::Mat2f image_pos;
+		if (input_parameters.getProjectionType() == ProjectionType::equirectangular) {
+			image_pos = warp_kernel(EquirectangularUnprojector::Kernel(input_parameters), virtual_parameters, get_rotation(), get_translation(), scale, input_uv, input_depth, world_pos, depth);
 		}
 		else {
-			std::ostringstream what;
-			what << "Unknown projection type \"" << parameters->getProjectionType() << "\"";
-			throw std::runtime_error(what.str());
+			image_pos = warp_kernel(PerspectiveUnprojector::Kernel(input_parameters), virtual_parameters, get_rotation(), get_translation(), scale, input_uv, input_depth, world_pos, depth);
 		}
+
+		wrapping_method = virtual_parameters.getProjectionType() == ProjectionType::equirectangular && virtual_parameters.isFullHorRange()
+			? WrappingMethod::horizontal
+			: WrappingMethod::none;
+
+		return image_pos;
+	}
+
+	void GenericTransformer::set_inputPosition(Parameters const *parameters)
+	{
+		assert(parameters);
+		SpaceTransformer::set_inputPosition(parameters);
+		m_unprojector = createUnprojector(*parameters);
+		m_input_projector = createProjector(*parameters);
 	}
 
 	void GenericTransformer::set_targetPosition(Parameters const *parameters)
 	{
 		assert(parameters);
 		SpaceTransformer::set_targetPosition(parameters);
-
-		if (parameters->getProjectionType() == ProjectionType::equirectangular) {
-			m_projector.reset(new EquirectangularProjector(*parameters));
-		}
-		else if (parameters->getProjectionType() == ProjectionType::perspective) {
-			m_projector.reset(new PerspectiveProjector(*parameters));
-		}
-		else {
-			std::ostringstream what;
-			what << "Unknown projection type \"" << parameters->getProjectionType() << "\"";
-			throw std::runtime_error(what.str());
-		}
+		m_projector = createProjector(*parameters);
+		m_virtual_unprojector = createUnprojector(*parameters);
 	}
 
 	cv::Mat2f GenericTransformer::generateImagePos() const
@@ -88,6 +88,28 @@ namespace rvs
 		cv::Mat2f project(cv::Mat3f world_pos, /*out*/ cv::Mat1f& depth, /*out*/ WrappingMethod& wrapping_method) const;
 		cv::Mat3f unproject(cv::Mat2f image_pos, cv::Mat1f depth) const;
 
+		/** Backward warping: positions in the input image of virtual view pixels with a known depth
+
+		@param virtual_image_pos Positions in the virtual image (at the resolution of the virtual camera)
+		@param virtual_depth Depth in the virtual view (NaN or <= 0 for invalid)
+		@return Positions in the input image (NaN for invalid)
+		*/
+		cv::Mat2f reproject(cv::Mat2f virtual_image_pos, cv::Mat1f virtual_depth) const;
+
+		/** Forward warping: unproject, transform and project the input view in a single pass
+
+		The pass is specialised at compile time for the projection types of the input and virtual views, so the per-pixel
+		work is inlined and the intermediate world positions of the virtual view are never stored.
+
+		@param input_depth Depth of the input view (only used when world_pos is empty)
+		@param output_size Size of the output (the virtual view size with oversampling)
+		@param[in,out] world_pos World positions in the input view (computed and assigned when empty)
+		@param[out] depth Depth in the virtual view
+		@param[out] wrapping_method Wrapping method of the virtual view
+		@return Positions in the output image (NaN for invalid)
+		*/
+		cv::Mat2f warp(cv::Mat1f input_depth, cv::Size output_size, /*in,out*/ cv::Mat3f& world_pos, /*out*/ cv::Mat1f& depth, /*out*/ WrappingMethod& wrapping_method) const;
+
 		void set_targetPosition(Parameters const *params_virtual) override;
 		void set_inputPosition(Parameters const *params_real) override;
 
@@ -97,6 +119,10 @@ namespace rvs
 	protected:
 		std::unique_ptr<Unprojector> m_unprojector;
 		std::unique_ptr<Projector> m_projector;
+
+		// For reproject()
+		std::unique_ptr<Unprojector> m_virtual_unprojector;
+		std::unique_ptr<Projector> m_input_projector;
 	};
 
 	class OpenGLTransformer : public SpaceTransformer {};
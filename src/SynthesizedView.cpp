@@ -48,9 +48,13 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "transform.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <memory>
 
 #if WITH_OPENGL
+#include "BatchedSynthesis.hpp"
 #include "helpersGL.hpp"
 #include "RFBO.hpp"
 #endif
@@ -59,25 +63,29 @@ namespace rvs
 {
 	namespace
 	{
-		// Affine transformation: x -> Rx + t
-		cv::Mat3f affine_transform(cv::Mat3f x, cv::Matx33f R, cv::Vec3f t)
-		{
-			auto y = cv::Mat3f(x.size());
-
-			for (int i = 0; i != y.rows; ++i) {
-				for (int j = 0; j != y.cols; ++j) {
-					y(i, j) = R * x(i, j) + t;
-				}
-			}
-
-			return y;
-		}
+		// Width of the largest blocks of the mesh decimation
+		int const max_block_size = 32;
 	}
 
 	SynthesizedView::SynthesizedView() {}
 
 	SynthesizedView::~SynthesizedView() {}
 
+	void SynthesizedView::prepare(View& input, Parameters const& params_real) const
+	{
+		if (isDecimated(input, params_real) && !input.get_triangulation()) {
+			input.set_triangulation(std::make_shared<detail::Triangulation>(detail::decimate_depth(input.get_depth(), m_mesh_decimation, max_block_size)));
+		}
+	}
+
+	bool SynthesizedView::isDecimated(View const& input, Parameters const& params_real) const
+	{
+		// The planarity test assumes that the inverse depth of a plane is linear in image coordinates, which only holds for
+		// perspective input views
+		return m_mesh_decimation > 0.f && input.get_displacementMethod() == DisplacementMethod::depth
+			&& params_real.getProjectionType() == ProjectionType::perspective;
+	}
+
 	void SynthesizedView::compute(View& input)
 	{
 		assert(m_space_transformer);
@@ -86,6 +94,16 @@ namespace rvs
 		auto t = m_space_transformer->get_translation();
 		distance_from_origin = cv::max(0.01,cv::norm(t));
 
+		m_raster_statistics = detail::RasterStatistics();
+
+		// Adaptive triangulation: only depends on the input view, so it is kept with the view for when it is warped again
+		m_triangulation.reset();
+		auto const& params_real = m_space_transformer->getInputParameters();
+		if (isDecimated(input, params_real)) {
+			prepare(input, params_real);
+			m_triangulation = input.get_triangulation();
+		}
+
 #if WITH_OPENGL
 		GLuint nl_mask_idx = 0;
 #endif
@@ -108,16 +126,16 @@ namespace rvs
 			cv::morphologyEx(newmask, newmask, cv::MORPH_CLOSE, cv::getStructuringElement(0, cv::Size(5, 5)), cv::Point(-1, -1), 2);
 			cv::morphologyEx(newmask, newmask, cv::MORPH_OPEN, cv::getStructuringElement(0, cv::Size(5, 5)));
 #if WITH_OPENGL
-			if (g_with_opengl) {
-				nl_mask_idx = opengl::cvMat2glTexture(newmask);
+			if (m_context.with_opengl) {
+				nl_mask_idx = m_context.gpu_resources->texture(newmask, 8);
 			}
 #endif
 		}
 
 #if WITH_OPENGL
-		if (g_with_opengl) {
-			auto ogl_transformer = static_cast<const OpenGLTransformer*>(m_space_transformer);
-			GLuint image_texture = opengl::cvMat2glTexture(input.get_color());
+		if (m_context.with_opengl) {
+			auto& resources = *m_context.gpu_resources;
+			GLuint image_texture = resources.texture(input.get_color(), 0);
 			GLuint depth_texture;
 			GLuint mask_texture;
 			GLuint polynomial1_texture;
@@ -126,7 +144,7 @@ namespace rvs
 			GLuint polynomial4_texture;
 			GLuint polynomial5_texture;
 			if (input.get_displacementMethod() == DisplacementMethod::depth)
-				depth_texture = opengl::cvMat2glTexture(input.get_depth() / input.get_max_depth());
+				depth_texture = resources.texture(input.get_depth() / input.get_max_depth(), 1);
 			if (input.get_displacementMethod() == DisplacementMethod::polynomial) {
 				std::array<cv::Mat1f, 20> polynomial = input.get_polynomial_depth().m_polynomial;
 				std::vector<cv::Mat1f> pol1 = { polynomial[0],polynomial[1],polynomial[2],polynomial[3] };
@@ -140,34 +158,29 @@ namespace rvs
 				cv::merge(pol3, p3);
 				cv::merge(pol4, p4);
 				cv::merge(pol5, p5);
-				depth_texture = opengl::cvMat2glTexture(polynomial[9]);
-				mask_texture = opengl::cvMat2glTexture(polynomial[19]);
-				polynomial1_texture = opengl::cvMat2glTexture(p1);
-				polynomial2_texture = opengl::cvMat2glTexture(p2);
-				polynomial3_texture = opengl::cvMat2glTexture(p3);
-				polynomial4_texture = opengl::cvMat2glTexture(p4);
-				polynomial5_texture = opengl::cvMat2glTexture(p5);
+				depth_texture = resources.texture(polynomial[9], 1);
+				mask_texture = resources.texture(polynomial[19], 2);
+				polynomial1_texture = resources.texture(p1, 3);
+				polynomial2_texture = resources.texture(p2, 4);
+				polynomial3_texture = resources.texture(p3, 5);
+				polynomial4_texture = resources.texture(p4, 6);
+				polynomial5_texture = resources.texture(p5, 7);
 			}
 
-			auto FBO = opengl::RFBO::getInstance();
+			auto FBO = m_context.fbo.get();
 			auto& shaders = opengl::ShadersList::getInstance();
 
-			float w = float(input.get_size().width);//.get_depth().cols);
-			float h = float(input.get_size().height);//.get_depth().rows);
-			float n_w = float(ogl_transformer->getVirtualParameters().getSize().width);
-			float n_h = float(ogl_transformer->getVirtualParameters().getSize().height);
-
-			glm::vec3 translation = glm::vec3(t[0], t[1], t[2]);
-			glm::mat3x3 rotation(0);
-			opengl::fromCV2GLM<3, 3>(cv::Mat(R), &rotation);
-
-			const opengl::VAO_VBO_EBO vve(input.get_depth().size());
+			// The mesh of the full triangulation is shared; a decimated one is specific to this input view
+			std::unique_ptr<opengl::VAO_VBO_EBO> decimated;
+			if (!getTriangulation().empty()) {
+				decimated.reset(new opengl::VAO_VBO_EBO(input.get_depth().size(), getTriangulation()));
+			}
+			auto const& vve = decimated ? *decimated : resources.mesh(input.get_depth().size());
 
-			GLuint program;
-			if (input.get_displacementMethod() == DisplacementMethod::polynomial)
-				program = shaders("synthesis_polynomial").getProgramID();
-           		 else
-				program = shaders("synthesis").getProgramID();
+			auto const& shader = input.get_displacementMethod() == DisplacementMethod::polynomial
+				? shaders("synthesis_polynomial")
+				: shaders("synthesis");
+			GLuint program = shader.getProgramID();
 			assert(program != 0);
 
 			glEnable(GL_DEPTH_TEST);
@@ -179,99 +192,47 @@ namespace rvs
 
 			glActiveTexture(GL_TEXTURE0);
 			glBindTexture(GL_TEXTURE_2D, image_texture);
-			glUniform1i(glGetUniformLocation(program, "image_texture"), 0);
+			glUniform1i(shader.uniform("image_texture"), 0);
 
 			glActiveTexture(GL_TEXTURE1);
 			glBindTexture(GL_TEXTURE_2D, depth_texture);
-			glUniform1i(glGetUniformLocation(program, "depth_texture"), 1);
+			glUniform1i(shader.uniform("depth_texture"), 1);
 	
 			if (input.get_displacementMethod() == DisplacementMethod::polynomial){
 				glActiveTexture(GL_TEXTURE2);
 				glBindTexture(GL_TEXTURE_2D, mask_texture);
-				glUniform1i(glGetUniformLocation(program, "mask_texture"), 2);
+				glUniform1i(shader.uniform("mask_texture"), 2);
 
 				glActiveTexture(GL_TEXTURE3);
 				glBindTexture(GL_TEXTURE_2D, polynomial1_texture);
-				glUniform1i(glGetUniformLocation(program, "polynomial1_texture"), 3);
+				glUniform1i(shader.uniform("polynomial1_texture"), 3);
 
 				glActiveTexture(GL_TEXTURE4);
 				glBindTexture(GL_TEXTURE_2D, polynomial2_texture);
-				glUniform1i(glGetUniformLocation(program, "polynomial2_texture"), 4);
+				glUniform1i(shader.uniform("polynomial2_texture"), 4);
 
 				glActiveTexture(GL_TEXTURE5);
 				glBindTexture(GL_TEXTURE_2D, polynomial3_texture);
-				glUniform1i(glGetUniformLocation(program, "polynomial3_texture"), 5);
+				glUniform1i(shader.uniform("polynomial3_texture"), 5);
 
 				glActiveTexture(GL_TEXTURE6);
 				glBindTexture(GL_TEXTURE_2D, polynomial4_texture);
-				glUniform1i(glGetUniformLocation(program, "polynomial4_texture"), 6);
+				glUniform1i(shader.uniform("polynomial4_texture"), 6);
 
 				glActiveTexture(GL_TEXTURE7);
 				glBindTexture(GL_TEXTURE_2D, polynomial5_texture);
-				glUniform1i(glGetUniformLocation(program, "polynomial5_texture"), 7);
+				glUniform1i(shader.uniform("polynomial5_texture"), 7);
 
 				glActiveTexture(GL_TEXTURE8);
 				glBindTexture(GL_TEXTURE_2D, nl_mask_idx);
-				glUniform1i(glGetUniformLocation(program, "nl_output_mask"), 8);
+				glUniform1i(shader.uniform("nl_output_mask"), 8);
 			}
 
 
-			// parameters
-			glUniformMatrix3fv(glGetUniformLocation(program, "R"), 1, GL_FALSE, glm::value_ptr(rotation));
-			glUniform3fv(glGetUniformLocation(program, "t"), 1, glm::value_ptr(translation));
-			glUniform1f(glGetUniformLocation(program, "w"), w);
-			glUniform1f(glGetUniformLocation(program, "h"), h);
-			glUniform1f(glGetUniformLocation(program, "n_w"), n_w);
-			glUniform1f(glGetUniformLocation(program, "n_h"), n_h);
-			glUniform1f(glGetUniformLocation(program, "max_depth"), static_cast<InputView&>(input).get_max_depth());
-
-			auto input_projection_type = ogl_transformer->getInputParameters().getProjectionType();
-			auto output_projection_type = ogl_transformer->getVirtualParameters().getProjectionType();
-			glUniform1i(glGetUniformLocation(program, "erp_in"), input_projection_type == ProjectionType::equirectangular);
-			glUniform1i(glGetUniformLocation(program, "erp_out"), output_projection_type == ProjectionType::equirectangular);
-
-			if (input_projection_type == ProjectionType::perspective) {
-				auto f = ogl_transformer->getInputParameters().getFocal();
-				auto p = ogl_transformer->getInputParameters().getPrinciplePoint();
-				glUniform2fv(glGetUniformLocation(program, "f"), 1, f.val);
-				glUniform2fv(glGetUniformLocation(program, "p"), 1, p.val);
-			}
-			else if (input_projection_type == ProjectionType::equirectangular) {
-				auto hor_range = ogl_transformer->getInputParameters().getHorRange();
-				auto ver_range = ogl_transformer->getInputParameters().getVerRange();
-				auto constexpr radperdeg = 0.01745329252f;
-				glUniform1f(glGetUniformLocation(program, "phi0"), radperdeg * hor_range[1]);
-				glUniform1f(glGetUniformLocation(program, "theta0"), radperdeg * ver_range[1]);
-				glUniform1f(glGetUniformLocation(program, "dphi_du"), -radperdeg * (hor_range[1] - hor_range[0]) / w);
-				glUniform1f(glGetUniformLocation(program, "dtheta_dv"), -radperdeg * (ver_range[1] - ver_range[0]) / h);
-			}
-			else {
-				throw std::logic_error("Unknown projection type (with OpenGL)");
-			}
-
-			if (output_projection_type == ProjectionType::perspective) {
-				auto n_f = ogl_transformer->getVirtualParameters().getFocal();
-				auto n_p = ogl_transformer->getVirtualParameters().getPrinciplePoint();
-				glUniform2fv(glGetUniformLocation(program, "n_f"), 1, n_f.val);
-				glUniform2fv(glGetUniformLocation(program, "n_p"), 1, n_p.val);
-			}
-			else if (output_projection_type == ProjectionType::equirectangular) {
-				auto hor_range = ogl_transformer->getVirtualParameters().getHorRange();
-				auto ver_range = ogl_transformer->getVirtualParameters().getVerRange();
-				auto constexpr degperrad = 57.295779513f;
-				glUniform1f(glGetUniformLocation(program, "u0"), (hor_range[0] + hor_range[1]) / (hor_range[1] - hor_range[0]));
-				glUniform1f(glGetUniformLocation(program, "v0"), -(ver_range[0] + ver_range[1]) / (ver_range[1] - ver_range[0]));
-				glUniform1f(glGetUniformLocation(program, "du_dphi"), -2.f * degperrad / (hor_range[1] - hor_range[0]));
-				glUniform1f(glGetUniformLocation(program, "dv_dtheta"), +2.f * degperrad / (ver_range[1] - ver_range[0]));
-			}
-			else {
-				throw std::logic_error("Unknown projection type (with OpenGL)");
-			}
-
-			// end parameters
+			auto parameters = opengl::view_parameters(input, *m_space_transformer);
+			resources.uniform_buffer(opengl::ViewParameters::binding, &parameters, sizeof(parameters));
 
 			glBindVertexArray(vve.VAO);
-			printf("Number of elements %i\n", int(vve.number_of_elements));
 			glDrawElements(GL_TRIANGLES, int(vve.number_of_elements), GL_UNSIGNED_INT, nullptr);
 			glUseProgram(0);
 			glBindVertexArray(0);
@@ -279,54 +240,50 @@ namespace rvs
 			glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
 			glDisable(GL_DEPTH_TEST);
-			
-			glDeleteTextures(GLsizei(1), &image_texture);
-			glDeleteTextures(GLsizei(1), &depth_texture);
-			if (input.get_displacementMethod() == DisplacementMethod::polynomial) {
-				glDeleteTextures(GLsizei(1), &mask_texture);
-				glDeleteTextures(GLsizei(1), &polynomial1_texture);
-				glDeleteTextures(GLsizei(1), &polynomial2_texture);
-				glDeleteTextures(GLsizei(1), &polynomial3_texture);
-				glDeleteTextures(GLsizei(1), &polynomial4_texture);
-				glDeleteTextures(GLsizei(1), &polynomial5_texture);
-				
-				glDeleteTextures(GLsizei(1), &nl_mask_idx);
-				
-			}
 		}
 #endif
-		if (!g_with_opengl) {
+		if (!m_context.with_opengl) {
 			auto const& pu_transformer = static_cast<const GenericTransformer*>(m_space_transformer);
 
-			// Generate image coordinates
-			auto input_uv = pu_transformer->generateImagePos();
-
-			// Unproject: input view image to input view world coordinates
-			auto input_xyz = pu_transformer->unproject(input_uv, input.get_depth());
-
-			// Rotate and translate from input (real) to output (virtual) view
-			auto virtual_xyz = affine_transform(input_xyz, R, t);
-
-			// Project: output view world to output view image coordinates
-			cv::Mat1f virtual_depth; // Depth
-			WrappingMethod wrapping_method;
-			auto virtual_uv = pu_transformer->project(virtual_xyz, /*out*/ virtual_depth, /*out*/ wrapping_method);
+			// Epipole: the center of the virtual camera (x = -R^T t) in homogeneous input image coordinates relative to the pixel centers
+			m_epipole = cv::Vec3f();
+			auto const& input_parameters = pu_transformer->getInputParameters();
+			if (m_occlusion_order && input_parameters.getProjectionType() == ProjectionType::perspective) {
+				cv::Vec3f center = -(R.t() * t);
+				auto f = input_parameters.getFocal();
+				auto p = input_parameters.getPrinciplePoint();
+				m_epipole = cv::Vec3f(
+					(p[0] - 0.5f) * center[0] - f[0] * center[1],
+					(p[1] - 0.5f) * center[0] - f[1] * center[2],
+					center[0]);
+			}
 
-			// Resize: rasterize with oversampling
+			// Warp: unproject, rotate and translate from input (real) to output (virtual) view, and project at the oversampled size
+			// The input world positions only depend on the input view, so they are kept with the view for when it is warped again
 			auto virtual_size = pu_transformer->getVirtualParameters().getSize();
 			auto output_size = cv::Size(
-				int(0.5f + virtual_size.width * detail::g_rescale),
-				int(0.5f + virtual_size.height * detail::g_rescale));
-			cv::Mat2f scaled_uv;
-			cv::transform(virtual_uv, scaled_uv, cv::Matx22f(
-				float(output_size.width) / virtual_size.width, 0.f,
-				0.f, float(output_size.height) / virtual_size.height));
+				int(0.5f + virtual_size.width * m_context.rescale),
+				int(0.5f + virtual_size.height * m_context.rescale));
+			auto input_xyz = input.get_world_pos();
+			auto cached = !input_xyz.empty();
+			cv::Mat1f virtual_depth; // Depth
+			WrappingMethod wrapping_method;
+			auto scaled_uv = pu_transformer->warp(input.get_depth(), output_size, /*in,out*/ input_xyz, /*out*/ virtual_depth, /*out*/ wrapping_method);
+			if (!cached) {
+				input.set_world_pos(input_xyz);
+			}
 
 			// Rasterization results in a color, depth and quality map
 			transform(input.get_color(), scaled_uv, virtual_depth, output_size, wrapping_method);
 		}
 	}
 
+	detail::Triangulation const& SynthesizedView::getTriangulation() const
+	{
+		static const detail::Triangulation all_pixels;
+		return m_triangulation ? *m_triangulation : all_pixels;
+	}
+
 	SynthetisedViewTriangle::SynthetisedViewTriangle() {}
 
 	void SynthetisedViewTriangle::transform(cv::Mat3f input_color, cv::Mat2f input_positions, cv::Mat1f input_depth,
@@ -337,7 +294,97 @@ namespace rvs
 
 		bool wrapHorizontal = wrapping_method == WrappingMethod::horizontal ? true : false;
 
-		auto color = detail::transform_trianglesMethod(input_color, input_depth, input_positions, output_size, /*out*/ depth, /*out*/ validity, wrapHorizontal);
+		cv::Mat3f color;
+		if (getContext().tiled_oversampling) {
+			auto factor = static_cast<int>(getContext().rescale);
+			color = detail::transform_trianglesTiled(input_color, input_depth, input_positions, output_size / factor, /*out*/ depth, /*out*/ validity, wrapHorizontal, factor, getTriangulation(), getEpipole());
+		}
+		else {
+			color = detail::transform_trianglesMethod(input_color, input_depth, input_positions, output_size, /*out*/ depth, /*out*/ validity, wrapHorizontal, getContext().rescale, getTriangulation(), getEpipole(), getRasterStatisticsOutput());
+		}
+
+		assign(color, depth, validity / depth, validity);
+	}
+
+	SynthetisedViewBackwardWarp::SynthetisedViewBackwardWarp() {}
+
+	void SynthetisedViewBackwardWarp::transform(cv::Mat3f input_color, cv::Mat2f input_positions, cv::Mat1f input_depth,
+		cv::Size output_size, WrappingMethod wrapping_method)
+	{
+		auto const NaN = std::numeric_limits<float>::quiet_NaN();
+
+		// Forward: rasterize only depth and quality
+		cv::Mat1f depth;
+		cv::Mat1f validity;
+		bool wrapHorizontal = wrapping_method == WrappingMethod::horizontal;
+		if (getContext().tiled_oversampling) {
+			// The color is only fetched at the resolution of the virtual view
+			auto factor = static_cast<int>(getContext().rescale);
+			output_size = output_size / factor;
+			detail::rasterize_trianglesDepthTiled(input_depth, input_positions, output_size, /*out*/ depth, /*out*/ validity, wrapHorizontal, factor, getTriangulation(), getEpipole());
+		}
+		else {
+			detail::rasterize_trianglesDepth(input_depth, input_positions, output_size, /*out*/ depth, /*out*/ validity, wrapHorizontal, getContext().rescale, getTriangulation(), getEpipole(), getRasterStatisticsOutput());
+		}
+
+		// Output pixel centers at the resolution of the virtual camera, with their depth
+		auto const& transformer = static_cast<GenericTransformer const&>(getSpaceTransformer());
+		auto virtual_size = transformer.getVirtualParameters().getSize();
+		auto sx = float(virtual_size.width) / output_size.width;
+		auto sy = float(virtual_size.height) / output_size.height;
+		cv::Mat2f virtual_pos(output_size);
+		cv::Mat1f virtual_depth(output_size);
+#pragma omp parallel for
+		for (int i = 0; i < output_size.height; ++i) {
+			for (int j = 0; j < output_size.width; ++j) {
+				virtual_pos(i, j) = cv::Vec2f((j + 0.5f) * sx, (i + 0.5f) * sy);
+				virtual_depth(i, j) = validity(i, j) > 0.f ? depth(i, j) : NaN;
+			}
+		}
+
+		// Backward: positions in the input image, relative to pixel centers for sampling
+		cv::Mat2f map = transformer.reproject(virtual_pos, virtual_depth);
+		cv::Mat1b invalid = validity <= 0.f;
+#pragma omp parallel for
+		for (int i = 0; i < output_size.height; ++i) {
+			for (int j = 0; j < output_size.width; ++j) {
+				auto& p = map(i, j);
+				if (invalid(i, j) || std::isnan(p[0]) || std::isnan(p[1])) {
+					p = cv::Vec2f::all(-1.f);
+					invalid(i, j) = 255;
+					validity(i, j) = 0.f;
+				}
+				else {
+					p -= cv::Vec2f::all(0.5f);
+				}
+			}
+		}
+
+		// Bilinear sampling of the input color
+		cv::Mat3f color;
+		cv::remap(input_color, color, map, cv::noArray(), cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+		color.setTo(cv::Vec3f::all(0.f), invalid);
+
+		assign(color, depth, validity / depth, validity);
+	}
+
+	SynthetisedViewSplat::SynthetisedViewSplat(float splat_size)
+		: m_splat_size(splat_size)
+	{}
+
+	void SynthetisedViewSplat::transform(cv::Mat3f input_color, cv::Mat2f input_positions, cv::Mat1f input_depth,
+		cv::Size output_size, WrappingMethod wrapping_method)
+	{
+		cv::Mat1f depth;
+		cv::Mat1f validity;
+
+		bool wrapHorizontal = wrapping_method == WrappingMethod::horizontal;
+
+		auto color = detail::transform_splatMethod(input_color, input_depth, input_positions, output_size, /*out*/ depth, /*out*/ validity, wrapHorizontal, getContext().rescale, m_splat_size);
+		if (getContext().tiled_oversampling) {
+			// Splats are cheap to draw: resolve the whole oversampled view
+			color = detail::resolve_oversampling(color, depth, validity, static_cast<int>(getContext().rescale), /*out*/ depth, /*out*/ validity);
+		}
 
 		assign(color, depth, validity / depth, validity);
 	}
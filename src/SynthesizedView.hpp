@@ -84,6 +84,22 @@ namespace rvs
 		*/
 		void setSpaceTransformer(SpaceTransformer const * object) { m_space_transformer = object; };
 
+		/**
+		\brief Set the context of the pipeline (precision, OpenGL)
+		*/
+		void setContext(Context const& context) { m_context = context; };
+
+		/**
+		\brief Enable the adaptive triangulation of the input depth map (see detail::decimate_depth())
+		@param tolerance Relative depth tolerance of merged blocks, or 0 to triangulate all pixels
+		*/
+		void setMeshDecimation(float tolerance) { m_mesh_decimation = tolerance; };
+
+		/**
+		\brief Rasterize the triangles of perspective input views in occlusion-compatible order (see detail::transform_trianglesMethod())
+		*/
+		void setOcclusionOrder(bool enable) { m_occlusion_order = enable; };
+
 		/**
 		\brief Compute this view from the input View
 
@@ -95,6 +111,17 @@ namespace rvs
 		*/
 		void compute(View& img);
 
+		/**
+		\brief Compute the data that compute() keeps with the input view (the adaptive triangulation, see setMeshDecimation())
+
+		compute() only reads an input view that is prepared, such that several threads can warp it at the same time.
+		*/
+		void prepare(View& input, Parameters const& params_real) const;
+
+		/**
+		\brief Triangles, depth tests and pixel writes of the CPU rasterizer during the last compute() (zero with OpenGL or TiledOversampling)
+		*/
+		detail::RasterStatistics const& getRasterStatistics() const { return m_raster_statistics; };
 
 
 	protected:
@@ -104,8 +131,41 @@ namespace rvs
 		virtual void transform(cv::Mat3f input_color, cv::Mat2f input_positions, cv::Mat1f input_depth,
 			cv::Size output_size, WrappingMethod wrapping_method) = 0;
 
+		/**
+		\brief Context of the pipeline
+		*/
+		Context const& getContext() const { return m_context; };
+
+		/**
+		\brief SpaceTransformer (input view to world)
+		*/
+		SpaceTransformer const& getSpaceTransformer() const { return *m_space_transformer; };
+
+		/**
+		\brief Adaptive triangulation of the input view during compute(), or empty to triangulate all pixels
+		*/
+		detail::Triangulation const& getTriangulation() const;
+
+		/**
+		\brief Epipole of the virtual camera in the input view during compute() for the traversal order, or all zeros for raster order
+		*/
+		cv::Vec3f getEpipole() const { return m_epipole; };
+
+		/**
+		\brief Raster statistics of compute(), for the rasterizer to fill in
+		*/
+		detail::RasterStatistics* getRasterStatisticsOutput() { return &m_raster_statistics; };
+
 	private:
+		bool isDecimated(View const& input, Parameters const& params_real) const;
+
 		SpaceTransformer const *m_space_transformer = nullptr;
+		Context m_context;
+		float m_mesh_decimation = 0.f;
+		bool m_occlusion_order = false;
+		cv::Vec3f m_epipole;
+		std::shared_ptr<const detail::Triangulation> m_triangulation;
+		detail::RasterStatistics m_raster_statistics;
 	};
 
 	/**
@@ -159,6 +219,69 @@ namespace rvs
 		virtual void transform(cv::Mat3f input_color, cv::Mat2f input_positions, cv::Mat1f input_depth,
 			cv::Size output_size, WrappingMethod wrapping_method);
 	};
+
+	/**
+	  \brief Backward warping: the depth is warped forward, the color is fetched backward
+
+	  The triangles of the input view are rasterized as in SynthetisedViewTriangle, but only for depth and quality. Then
+	  each output pixel with a depth is reprojected into the input view (see GenericTransformer::reproject()), and its color
+	  is sampled bilinearly from the input color. The second stage is a gather per output pixel, without overwrites.
+
+	  Only without OpenGL.
+	  */
+	class SynthetisedViewBackwardWarp : public SynthesizedView {
+	public:
+		/**
+		\brief Constructor
+		*/
+		SynthetisedViewBackwardWarp();
+
+	protected:
+		/**
+		\brief Rasterize the warped depth and fetch the color for each output pixel, resulting in updates of color, depth and quality maps
+		@param input_color Input color image
+		@param input_positions New positions in the image of each pixel
+		@param input_depth Input depth map
+		@param output_size Size of the output image
+		@param wrapping_method Output warping method (perpective or equirectangular, see Projector)
+		\see rasterize_trianglesDepth()
+		*/
+		virtual void transform(cv::Mat3f input_color, cv::Mat2f input_positions, cv::Mat1f input_depth,
+			cv::Size output_size, WrappingMethod wrapping_method);
+	};
+
+	/**
+	  \brief Point splatting: each input pixel is drawn as a square with a z-buffer
+
+	  Cheaper than SynthetisedViewTriangle, for previews and pruning analysis. The depth, quality and validity maps have the
+	  same meaning as for the triangles, such that the BlendedView classes work unchanged.
+
+	  Only without OpenGL.
+	  */
+	class SynthetisedViewSplat : public SynthesizedView {
+	public:
+		/**
+		\brief Constructor
+		@param splat_size Width of a splat in virtual view pixels, or 0 for the distance between warped neighbours
+		*/
+		SynthetisedViewSplat(float splat_size);
+
+	protected:
+		/**
+		\brief Splat the warped pixels, resulting in updates of color, depth and quality maps
+		@param input_color Input color image
+		@param input_positions New positions in the image of each pixel
+		@param input_depth Input depth map
+		@param output_size Size of the output image
+		@param wrapping_method Output warping method (perpective or equirectangular, see Projector)
+		\see transform_splatMethod()
+		*/
+		virtual void transform(cv::Mat3f input_color, cv::Mat2f input_positions, cv::Mat1f input_depth,
+			cv::Size output_size, WrappingMethod wrapping_method);
+
+	private:
+		float m_splat_size;
+	};
 }
 
 #endif
\ No newline at end of file
@@ -64,26 +64,52 @@ namespace rvs
 	// Initialize all maps at once
 	void View::assign(cv::Mat3f color, cv::Mat1f depth, cv::Mat1f quality, cv::Mat1f validity)
 	{
+		m_packed = cv::Mat();
 		m_color = color;
 		m_depth = depth;
 		m_quality = quality;
 		m_validity = validity;
+		m_world_pos = cv::Mat3f();
+		m_triangulation.reset();
 		validate();
 	}
 	void View::assign(cv::Mat3f color, cv::Mat1f depth, cv::Mat1f quality, cv::Mat1f validity, PolynomialDepth polynomial_depth)
 	{
+		m_packed = cv::Mat();
 		m_color = color;
 		m_depth = depth;
 		m_quality = quality;
 		m_validity = validity;
+		m_world_pos = cv::Mat3f();
+		m_triangulation.reset();
 		m_polynomial_depth = polynomial_depth;
 		validate();
 	}
 
+	// Initialize all maps at once in the packed layout
+	void View::assign_packed(cv::Mat packed)
+	{
+		CV_Assert(packed.type() == CV_8UC(sizeof(detail::PackedPixel)));
+		m_packed = packed;
+		m_color = cv::Mat3f();
+		m_depth = cv::Mat1f();
+		m_quality = cv::Mat1f();
+		m_validity = cv::Mat1f();
+		m_world_pos = cv::Mat3f();
+		m_triangulation.reset();
+	}
+
+	// Return the packed maps
+	cv::Mat View::get_packed() const
+	{
+		return m_packed;
+	}
+
 	// Return the texture
 	cv::Mat3f View::get_color() const
 	{
 		validate();
+		unpack();
 		CV_Assert(!m_color.empty());
 		return m_color;
 	}
@@ -92,6 +118,7 @@ namespace rvs
 	cv::Mat1f View::get_depth() const
 	{
 		validate();
+		unpack();
 		CV_Assert(!m_depth.empty());
 		return m_depth;
 	}
@@ -111,6 +138,7 @@ namespace rvs
 	cv::Mat1f View::get_quality() const
 	{
 		validate();
+		unpack();
 		CV_Assert(!m_quality.empty());
 		return m_quality;
 	}
@@ -119,6 +147,7 @@ namespace rvs
 	cv::Mat1f View::get_validity() const
 	{
 		validate();
+		unpack();
 		CV_Assert(!m_validity.empty());
 		return m_validity;
 	}
@@ -127,12 +156,22 @@ namespace rvs
 	cv::Size View::get_size() const
 	{
 		validate();
-		return m_color.size();
+		return m_packed.empty() ? m_color.size() : m_packed.size();
 	}
 
 	// Return a mask with all valid depth values
 	cv::Mat1b View::get_depth_mask() const
 	{
+		if (!m_packed.empty()) {
+			cv::Mat1b depth_mask(m_packed.size());
+			for (int i = 0; i != depth_mask.rows; ++i) {
+				auto p = m_packed.ptr<detail::PackedPixel>(i);
+				for (int j = 0; j != depth_mask.cols; ++j) {
+					depth_mask(i, j) = p[j].depth > 0.f ? 255 : 0; // excludes NaN's
+				}
+			}
+			return depth_mask;
+		}
 		return get_depth() > 0.f; // excludes NaN's
 	}
 
@@ -140,6 +179,17 @@ namespace rvs
 	cv::Mat1b View::get_inpaint_mask() const
 	{
 		auto inpaint_mask = cv::Mat1b(get_size(), 255);
+		if (!m_packed.empty()) {
+			for (int i = 0; i != inpaint_mask.rows; ++i) {
+				auto p = m_packed.ptr<detail::PackedPixel>(i);
+				for (int j = 0; j != inpaint_mask.cols; ++j) {
+					if (p[j].quality > 0.f) { // excludes NaN's
+						inpaint_mask(i, j) = 0;
+					}
+				}
+			}
+			return inpaint_mask;
+		}
 		inpaint_mask.setTo(0, get_quality() > 0.f); // excludes NaN's
 		return inpaint_mask;
 	}
@@ -148,10 +198,54 @@ namespace rvs
 	cv::Mat1b View::get_validity_mask(float threshold) const
 	{
 		auto validity_mask = cv::Mat1b(get_size(), 255);
+		if (!m_packed.empty()) {
+			for (int i = 0; i != validity_mask.rows; ++i) {
+				auto p = m_packed.ptr<detail::PackedPixel>(i);
+				for (int j = 0; j != validity_mask.cols; ++j) {
+					if (p[j].validity > threshold) { // excludes NaN's
+						validity_mask(i, j) = 0;
+					}
+				}
+			}
+			return validity_mask;
+		}
 		validity_mask.setTo(0, get_validity() > threshold); // excludes NaN's
 		return validity_mask;
 	}
 
+	// Return the cached unprojected pixel positions
+	cv::Mat3f View::get_world_pos() const
+	{
+		return m_world_pos;
+	}
+
+	// Cache the unprojected pixel positions
+	void View::set_world_pos(cv::Mat3f world_pos)
+	{
+		CV_Assert(world_pos.empty() || world_pos.size() == m_depth.size());
+		m_world_pos = world_pos;
+	}
+
+	// Return the cached triangulation
+	std::shared_ptr<const detail::Triangulation> View::get_triangulation() const
+	{
+		return m_triangulation;
+	}
+
+	// Cache the triangulation
+	void View::set_triangulation(std::shared_ptr<const detail::Triangulation> triangulation)
+	{
+		m_triangulation = triangulation;
+	}
+
+	// Split the packed maps on first use
+	void View::unpack() const
+	{
+		if (!m_packed.empty() && m_color.empty()) {
+			detail::unpack_view(m_packed, m_color, m_depth, m_quality, m_validity);
+		}
+	}
+
 	void View::validate() const
 	{
 		auto size = m_color.size();
@@ -161,12 +255,13 @@ namespace rvs
 	}
 
 	// Load a color image and depth map
-	InputView::InputView(std::string const& filepath_color, std::string const& filepath_depth, int frame, Parameters const& parameters)
+	InputView::InputView(std::string const& filepath_color, std::string const& filepath_depth, int frame, Parameters const& parameters, detail::ColorSpace color_space)
 		:
+		parameters(parameters),
 		filepath_color(filepath_color),
 		filepath_depth(filepath_depth),
 		frame(frame),
-		parameters(parameters)
+		color_space(color_space)
 	{
 		load();
 	}
@@ -175,7 +270,7 @@ namespace rvs
 	void InputView::load()
 	{
 		if (parameters.getDisplacementMethod() == DisplacementMethod::depth) {
-			cv::Mat3f a = read_color(filepath_color, frame, parameters);
+			cv::Mat3f a = read_color(filepath_color, frame, parameters, color_space);
 			assign(
 				a,
 				read_depth(filepath_depth, frame, parameters),
@@ -186,7 +281,7 @@ namespace rvs
 		{
 		        if (parameters.getDisplacementMethod()==DisplacementMethod::polynomial){
                         assign(
-                            read_color(filepath_color, frame, parameters),
+                            read_color(filepath_color, frame, parameters, color_space),
                             cv::Mat1f::zeros(parameters.getSize()),
                             cv::Mat1f(),
                             cv::Mat1f(),
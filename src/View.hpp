@@ -50,8 +50,13 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #if WITH_OPENGL
 #include "helpersGL.hpp"
 #endif
+#include "Context.hpp"
 #include "Parameters.hpp"
 #include "PolynomialDepth.hpp"
+#include "blending.hpp"
+#include "transform.hpp"
+
+#include <memory>
 
 /**
 @file View.hpp
@@ -76,6 +81,15 @@ namespace rvs
 		void assign(cv::Mat3f, cv::Mat1f, cv::Mat1f, cv::Mat1f);
 		void assign(cv::Mat3f, cv::Mat1f, cv::Mat1f, cv::Mat1f, rvs::PolynomialDepth);
 
+		/** Assign all maps at once in the packed layout (see detail::PackedPixel)
+
+		The other getters unpack the maps on first use; the masks are computed from the packed view directly.
+		*/
+		void assign_packed(cv::Mat packed);
+
+		/** @return the maps in the packed layout (empty when the view is not packed) */
+		cv::Mat get_packed() const;
+
 		/** @return the texture */
 		cv::Mat3f get_color() const;
 
@@ -103,6 +117,18 @@ namespace rvs
 		/** @return a mask for invalid masking */
 		cv::Mat1b get_validity_mask(float threshold) const;
 
+		/** @return the unprojected pixel positions in the coordinate system of this view (empty when not computed yet) */
+		cv::Mat3f get_world_pos() const;
+
+		/** Keep the unprojected pixel positions with the view, such that warping the view again skips the unprojection */
+		void set_world_pos(cv::Mat3f);
+
+		/** @return the adaptive triangulation of the depth map (null when not computed yet, see detail::decimate_depth()) */
+		std::shared_ptr<const detail::Triangulation> get_triangulation() const;
+
+		/** Keep the adaptive triangulation with the view, such that the depth map is decimated once per frame */
+		void set_triangulation(std::shared_ptr<const detail::Triangulation>);
+
 		virtual float get_max_depth() const { return 1.0; };
 		virtual float get_min_depth() const { return 0.0; };
 		virtual DisplacementMethod get_displacementMethod() const {return DisplacementMethod::depth;};
@@ -112,11 +138,16 @@ namespace rvs
 
 	private:
 		void validate() const;
-
-		cv::Mat3f m_color;
-		cv::Mat1f m_depth;
-		cv::Mat1f m_quality;
-		cv::Mat1f m_validity;
+		void unpack() const;
+
+		// Separate maps (unpacked on first use for a packed view)
+		mutable cv::Mat3f m_color;
+		mutable cv::Mat1f m_depth;
+		mutable cv::Mat1f m_quality;
+		mutable cv::Mat1f m_validity;
+		cv::Mat m_packed;
+		cv::Mat3f m_world_pos;
+		std::shared_ptr<const detail::Triangulation> m_triangulation;
 		rvs::PolynomialDepth m_polynomial_depth;
 	};
 
@@ -128,9 +159,9 @@ namespace rvs
 	public:
 		/** Constructor.
 
-		Loads an input view and its depth map.
+		Loads an input view and its depth map. The color is converted to the working color space.
 		*/
-		InputView(std::string const& filepath_color, std::string const& filepath_depth, int frame, Parameters const& parameters);
+		InputView(std::string const& filepath_color, std::string const& filepath_depth, int frame, Parameters const& parameters, detail::ColorSpace color_space);
 
 
 		/** @return the size of the texture and depth map */
@@ -150,6 +181,7 @@ namespace rvs
 		std::string filepath_color;
 		std::string filepath_depth;
 		int frame;
+		detail::ColorSpace color_space;
 		bool loaded = false;
 	};
 }
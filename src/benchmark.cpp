@@ -0,0 +1,282 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+/**
+@file benchmark.cpp
+\brief RVSBench: timings and counters of the rasterization on a synthetic view, and of the blending of the warped views
+
+Usage: RVSBench [--size WIDTHxHEIGHT] [--repeat N]
+*/
+
+#include "BlendedView.hpp"
+#include "transform.hpp"
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Synthetic perspective view: a slanted wall with boxes in front of it
+	struct Scene
+	{
+		cv::Mat3f color;
+		cv::Mat1f depth;
+		cv::Vec2f focal;
+		cv::Vec2f principle_point;
+	};
+
+	Scene createScene(cv::Size size)
+	{
+		Scene scene;
+		scene.focal = cv::Vec2f(float(size.width), float(size.width));
+		scene.principle_point = cv::Vec2f(0.5f * size.width, 0.5f * size.height);
+		scene.color = cv::Mat3f(size);
+		scene.depth = cv::Mat1f(size);
+
+		cv::RNG rng(42);
+		std::vector<std::pair<cv::Rect, float>> boxes;
+		for (int k = 0; k != 24; ++k) {
+			auto w = rng.uniform(size.width / 16, size.width / 4);
+			auto h = rng.uniform(size.height / 16, size.height / 4);
+			auto box = cv::Rect(rng.uniform(0, size.width - w), rng.uniform(0, size.height - h), w, h);
+			boxes.push_back(std::make_pair(box, rng.uniform(1.f, 3.f)));
+		}
+
+		for (int i = 0; i != size.height; ++i) {
+			for (int j = 0; j != size.width; ++j) {
+				auto d = 4.f + 2.f * j / size.width;
+				for (auto const& box : boxes) {
+					if (box.first.contains(cv::Point(j, i))) {
+						d = std::min(d, box.second);
+					}
+				}
+				scene.depth(i, j) = d;
+				scene.color(i, j) = cv::Vec3f(0.5f + 0.5f * std::sin(0.1f * j), 0.5f + 0.5f * std::cos(0.1f * i), d / 6.f);
+			}
+		}
+		return scene;
+	}
+
+	// Warped pixel positions for a translation of the camera (x -> x + t, OMAF referential: x forward, y left, z up),
+	// and the epipole in homogeneous coordinates relative to the pixel centers (see SynthesizedView::compute)
+	cv::Mat2f warp(Scene const& scene, cv::Vec3f t, cv::Vec3f& epipole)
+	{
+		auto const NaN = std::numeric_limits<float>::quiet_NaN();
+		auto f = scene.focal;
+		auto p = scene.principle_point;
+
+		cv::Mat2f positions(scene.depth.size());
+		for (int i = 0; i != positions.rows; ++i) {
+			for (int j = 0; j != positions.cols; ++j) {
+				auto d = scene.depth(i, j);
+				auto xyz = cv::Vec3f(d, -d / f[0] * (j + 0.5f - p[0]), -d / f[1] * (i + 0.5f - p[1])) + t;
+				positions(i, j) = xyz[0] > 0.f
+					? cv::Vec2f(-f[0] * xyz[1] / xyz[0] + p[0], -f[1] * xyz[2] / xyz[0] + p[1])
+					: cv::Vec2f::all(NaN);
+			}
+		}
+
+		cv::Vec3f center = -t;
+		epipole = cv::Vec3f(
+			(p[0] - 0.5f) * center[0] - f[0] * center[1],
+			(p[1] - 0.5f) * center[0] - f[1] * center[2],
+			center[0]);
+		return positions;
+	}
+
+	// Best time of a number of runs of the triangle rasterizer, and its counters
+	double benchmarkTriangles(Scene const& scene, cv::Mat2f positions, cv::Vec3f epipole, int repeat, rvs::detail::RasterStatistics& statistics)
+	{
+		auto best = std::numeric_limits<double>::infinity();
+		for (int k = 0; k != repeat; ++k) {
+			cv::Mat1f depth;
+			cv::Mat1f quality;
+			auto start = std::chrono::steady_clock::now();
+			rvs::detail::transform_trianglesMethod(scene.color, scene.depth, positions, scene.depth.size(), depth, quality, false, 1.f,
+				rvs::detail::Triangulation(), epipole, &statistics);
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	// Blender of a blending method, with the factors of the integration tests
+	std::unique_ptr<rvs::BlendedView> createBlender(std::string const& method)
+	{
+		if (method == "Multispectral") {
+			return std::unique_ptr<rvs::BlendedView>(new rvs::BlendedViewMultiSpec(1.f, 4.f));
+		}
+		if (method == "Laplacian") {
+			return std::unique_ptr<rvs::BlendedView>(new rvs::BlendedViewLaplacian(5.f));
+		}
+		return std::unique_ptr<rvs::BlendedView>(new rvs::BlendedViewSimple(1.f));
+	}
+
+	// Best time of a number of runs of the blending of the views, including the reads of the final color and inpainting mask
+	double benchmarkBlending(std::vector<rvs::View> const& views, std::string const& method, bool packed, int repeat)
+	{
+		rvs::Context context;
+		context.packed_views = packed;
+
+		auto best = std::numeric_limits<double>::infinity();
+		for (int k = 0; k != repeat; ++k) {
+			auto blender = createBlender(method);
+			blender->setContext(context);
+			auto start = std::chrono::steady_clock::now();
+			for (auto const& view : views) {
+				blender->blend(view);
+			}
+			blender->get_inpaint_mask();
+			blender->get_color();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	void printRow(char const* motion, char const* order, double milliseconds, rvs::detail::RasterStatistics const& statistics)
+	{
+		std::cout << std::left << std::setw(10) << motion << std::setw(11) << order
+			<< std::right << std::fixed << std::setprecision(2) << std::setw(10) << milliseconds << " ms"
+			<< std::setw(12) << statistics.triangles
+			<< std::setw(12) << statistics.tests
+			<< std::setw(12) << statistics.writes << '\n';
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	auto size = cv::Size(1920, 1080);
+	auto repeat = 5;
+
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc && std::sscanf(argv[i + 1], "%dx%d", &size.width, &size.height) == 2) {
+			++i;
+		}
+		else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			repeat = std::max(1, std::stoi(argv[++i]));
+		}
+		else {
+			std::cout << "Usage: RVSBench [--size WIDTHxHEIGHT] [--repeat N]\n";
+			return 1;
+		}
+	}
+
+	struct Motion
+	{
+		char const* name;
+		cv::Vec3f translation;
+	};
+	Motion const motions[] = {
+		{ "sideways", cv::Vec3f(0.f, -0.2f, 0.f) },
+		{ "forward", cv::Vec3f(-0.5f, 0.f, 0.f) },
+		{ "backward", cv::Vec3f(0.5f, 0.f, 0.f) },
+		{ "diagonal", cv::Vec3f(-0.3f, -0.1f, 0.1f) }
+	};
+
+	auto scene = createScene(size);
+	std::cout << "Triangles " << size << ", best of " << repeat << "\n\n";
+	std::cout << std::left << std::setw(10) << "motion" << std::setw(11) << "order" << std::right << std::setw(13) << "time"
+		<< std::setw(12) << "triangles" << std::setw(12) << "tests" << std::setw(12) << "writes" << '\n';
+
+	std::vector<rvs::View> views;
+	for (auto const& motion : motions) {
+		cv::Vec3f epipole;
+		auto positions = warp(scene, motion.translation, epipole);
+
+		cv::Mat1f depth;
+		cv::Mat1f validity;
+		auto color = rvs::detail::transform_trianglesMethod(scene.color, scene.depth, positions, size, depth, validity, false, 1.f,
+			rvs::detail::Triangulation(), cv::Vec3f());
+		views.push_back(rvs::View(color, depth, cv::Mat1f(validity / depth), validity));
+
+		rvs::detail::RasterStatistics raster;
+		auto raster_time = benchmarkTriangles(scene, positions, cv::Vec3f(), repeat, raster);
+		printRow(motion.name, "raster", raster_time, raster);
+
+		rvs::detail::RasterStatistics occlusion;
+		auto occlusion_time = benchmarkTriangles(scene, positions, epipole, repeat, occlusion);
+		printRow(motion.name, "occlusion", occlusion_time, occlusion);
+
+		std::cout << std::setw(34) << "writes saved: " << std::setprecision(1)
+			<< 100. * (1. - double(occlusion.writes) / std::max<std::size_t>(1, raster.writes)) << " %\n";
+	}
+
+	// Blended view: separate color, depth, quality, validity and depth mask maps, or one array of packed pixels
+	auto const separate_bytes = sizeof(cv::Vec3f) + 3 * sizeof(float) + sizeof(uchar);
+	auto const packed_bytes = sizeof(rvs::detail::PackedPixel);
+	auto separate_time = benchmarkBlending(views, "Simple", false, repeat);
+	auto packed_time = benchmarkBlending(views, "Simple", true, repeat);
+
+	std::cout << "\nSimple blending of " << views.size() << " views\n\n";
+	std::cout << std::left << std::setw(21) << "layout" << std::right << std::setw(13) << "time" << std::setw(12) << "bytes/pixel" << '\n';
+	std::cout << std::left << std::setw(21) << "separate" << std::right << std::fixed << std::setprecision(2)
+		<< std::setw(10) << separate_time << " ms" << std::setw(12) << separate_bytes << '\n';
+	std::cout << std::left << std::setw(21) << "packed" << std::right
+		<< std::setw(10) << packed_time << " ms" << std::setw(12) << packed_bytes << '\n';
+	std::cout << std::setw(34) << "bytes saved: " << std::setprecision(1)
+		<< 100. * (1. - double(packed_bytes) / separate_bytes) << " %\n";
+	std::cout << std::setw(34) << "time saved: "
+		<< 100. * (1. - packed_time / separate_time) << " %\n";
+
+	// Multi-band blending methods
+	std::cout << "\nMulti-band blending of " << views.size() << " views\n\n";
+	std::cout << std::left << std::setw(21) << "method" << std::right << std::setw(13) << "time" << '\n';
+	for (auto method : { "Multispectral", "Laplacian" }) {
+		std::cout << std::left << std::setw(21) << method << std::right << std::setprecision(2)
+			<< std::setw(10) << benchmarkBlending(views, method, false, repeat) << " ms\n";
+	}
+	return 0;
+}
@@ -46,9 +46,12 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 #include "blending.hpp"
 #include "IntegralImage2D.h"
-#include "Config.hpp"
+#include "Context.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 #include <opencv2/imgproc.hpp>
 
@@ -56,107 +59,111 @@ namespace rvs
 {
 	namespace detail
 	{
-		/**
-		 * Simple blur
-		 * */
-		void calcBlurring(cv::Mat img, cv::Mat &blr, cv::Mat msk, int rad)
+		void MaskedBoxBlur::apply(cv::Mat img, cv::Mat1b mask, int radius, cv::Mat& blurred)
 		{
-			int chn = img.channels();
-			if (chn == 1)
-			{
-				blr = cv::Mat(img.size().height, img.size().width, CV_32FC1);
+			CV_Assert(img.depth() == CV_32F && img.channels() <= 4 && mask.size() == img.size());
+			auto const channels = img.channels();
+			auto const rows = img.rows;
+			auto const cols = img.cols;
+			auto const width = cols * channels;
 
-				int srd_ele = 1;
-				int srd_row = srd_ele * img.size().width;
+			m_sum.create(rows, width);
+			m_count.create(rows, width);
 
-				IntegralImage2D<float, 1> iim_dx;
-				iim_dx.setInput((float*)img.data, msk.data, img.size().width, img.size().height, srd_ele, srd_row);
+			// Running sums over the rows of the included pixels
+#pragma omp parallel
+			{
+				std::vector<float> value(width);
+				std::vector<float> count(width);
+
+#pragma omp for
+				for (int y = 0; y < rows; ++y) {
+					auto src = img.ptr<float>(y);
+					auto m = mask.ptr<uchar>(y);
+					for (int x = 0; x < cols; ++x) {
+						auto total = 0.f;
+						for (int c = 0; c < channels; ++c) {
+							total += src[x * channels + c];
+						}
+						auto included = m[x] == 255 && std::isfinite(total);
+						for (int c = 0; c < channels; ++c) {
+							value[x * channels + c] = included ? src[x * channels + c] : 0.f;
+							count[x * channels + c] = included ? 1.f : 0.f;
+						}
+					}
 
-				int rad_2 = rad;
-				int rad_1 = int(2 * rad_2 + 1);
-#pragma omp parallel default(shared)
-				{
-#pragma omp for schedule(dynamic, 10) nowait
-					for (int i = 0; i < img.size().height; i++)
-					{
-						for (int j = 0; j < img.size().width; j++)
-						{
-							if (msk.at<uchar>(i, j) == 0)
-							{
-								blr.at<float>(i, j) = 0;
-								continue;
+					auto sum = m_sum.ptr<float>(y);
+					auto n = m_count.ptr<float>(y);
+					for (int c = 0; c < channels; ++c) {
+						double s = 0.;
+						double k = 0.;
+						for (int x = 0; x < std::min(radius, cols); ++x) {
+							s += value[x * channels + c];
+							k += count[x * channels + c];
+						}
+						for (int x = 0; x < cols; ++x) {
+							if (x + radius < cols) {
+								s += value[(x + radius) * channels + c];
+								k += count[(x + radius) * channels + c];
 							}
-
-
-							int start_x = j - rad_2;
-							int start_y = i - rad_2;
-							int end_y = start_y + rad_1;
-							int end_x = start_x + rad_1;
-
-							start_x = std::max(0, start_x);
-							start_y = std::max(0, start_y);
-							end_x = std::min(end_x, img.size().width);
-							end_y = std::min(end_y, img.size().height);
-
-							unsigned cnt = iim_dx.getFiniteElementsCountSE(start_x, start_y, end_x, end_y);
-							unsigned sum = (int)iim_dx.getFirstOrderSumSE(start_x, start_y, end_x, end_y);
-
-							if (cnt > 0)
-								blr.at<float>(i, j) = float(float(sum) / float(cnt));
+							if (x - radius - 1 >= 0) {
+								s -= value[(x - radius - 1) * channels + c];
+								k -= count[(x - radius - 1) * channels + c];
+							}
+							sum[x * channels + c] = static_cast<float>(s);
+							n[x * channels + c] = static_cast<float>(k);
 						}
 					}
 				}
 			}
-			else if (chn == 3)
-			{
-				blr = cv::Mat(img.size().height, img.size().width, CV_32FC3);
-
-				int srd_ele = sizeof(cv::Vec3f) / sizeof(float);
-				int srd_row = srd_ele * img.size().width;
-
-				IntegralImage2D<float, 3> iim_dx;
-				iim_dx.setInput((float*)img.data, msk.data, img.size().width, img.size().height, srd_ele, srd_row);
 
-				int rad_2 = rad;
-				int rad_1 = int(2 * rad_2 + 1);
-#pragma omp parallel default(shared)
-				{
-#pragma omp for schedule(dynamic, 10) nowait
-					for (int i = 0; i < img.size().height; i++)
-					{
-						for (int j = 0; j < img.size().width; j++)
-						{
-							if (msk.at<uchar>(i, j) == 0)
-							{
-								blr.at<cv::Vec3f>(i, j)[0] = 0;
-								blr.at<cv::Vec3f>(i, j)[1] = 0;
-								blr.at<cv::Vec3f>(i, j)[2] = 0;
-								continue;
-							}
-
-							int start_x = j - rad_2;
-							int start_y = i - rad_2;
-							int end_y = start_y + rad_1;
-							int end_x = start_x + rad_1;
-
-							start_x = std::max(0, start_x);
-							start_y = std::max(0, start_y);
-							end_x = std::min(end_x, img.size().width);
-							end_y = std::min(end_y, img.size().height);
-
-							unsigned count = iim_dx.getFiniteElementsCountSE(start_x, start_y, end_x, end_y);
-							cv::Vec3f sum = iim_dx.getFirstOrderSumSE(start_x, start_y, end_x, end_y);
-
-							if (count > 0) {
-								blr.at<cv::Vec3f>(i, j)[0] = float(float(sum[0]) / float(count));
-								blr.at<cv::Vec3f>(i, j)[1] = float(float(sum[1]) / float(count));
-								blr.at<cv::Vec3f>(i, j)[2] = float(float(sum[2]) / float(count));
-							}
+			// Running sums over the columns, in strips of contiguous values
+			cv::Mat result(img.size(), img.type());
+			int const strip = 256;
+#pragma omp parallel for
+			for (int i = 0; i < (width + strip - 1) / strip; ++i) {
+				auto const x0 = i * strip;
+				auto const w = std::min(strip, width - x0);
+				std::vector<double> s(w);
+				std::vector<double> k(w);
+
+				for (int y = 0; y < std::min(radius, rows); ++y) {
+					auto sum = m_sum.ptr<float>(y) + x0;
+					auto n = m_count.ptr<float>(y) + x0;
+					for (int x = 0; x < w; ++x) {
+						s[x] += sum[x];
+						k[x] += n[x];
+					}
+				}
+				for (int y = 0; y < rows; ++y) {
+					if (y + radius < rows) {
+						auto sum = m_sum.ptr<float>(y + radius) + x0;
+						auto n = m_count.ptr<float>(y + radius) + x0;
+						for (int x = 0; x < w; ++x) {
+							s[x] += sum[x];
+							k[x] += n[x];
 						}
 					}
+					if (y - radius - 1 >= 0) {
+						auto sum = m_sum.ptr<float>(y - radius - 1) + x0;
+						auto n = m_count.ptr<float>(y - radius - 1) + x0;
+						for (int x = 0; x < w; ++x) {
+							s[x] -= sum[x];
+							k[x] -= n[x];
+						}
+					}
+
+					auto m = mask.ptr<uchar>(y);
+					auto dst = result.ptr<float>(y) + x0;
+					for (int x = 0; x < w; ++x) {
+						auto included = m[(x0 + x) / channels] != 0 && k[x] > 0.5;
+						dst[x] = included ? static_cast<float>(s[x] / k[x]) : 0.f;
+					}
 				}
 			}
+			blurred = result;
 		}
+
 		/**
 		 * gaussian blur
 		 * */
@@ -291,100 +298,441 @@ namespace rvs
 		}
 
 		cv::Mat blend_img_by_max(const std::vector<cv::Mat>& imgs, const std::vector<cv::Mat>& qualities, const std::vector<cv::Mat>& depth_prolongations, cv::Vec3f empty_color, cv::Mat& quality, cv::Mat& depth_prolongation_mask, cv::Mat& inpaint_mask) {
-			cv::Mat3f color = cv::Mat3f(imgs.front().size(), empty_color);
-			quality = cv::Mat1f::zeros(imgs[0].size());
-			depth_prolongation_mask = cv::Mat1b::zeros(imgs[0].size());
-			inpaint_mask = cv::Mat1b::zeros(imgs[0].size());
-
-			for (std::size_t i = 0; i != imgs.size(); ++i) {
-				cv::Mat1b mask = qualities[i] > quality;
-				imgs[i].copyTo(color, mask);
-				qualities[i].copyTo(quality, mask);
-				depth_prolongations[i].copyTo(depth_prolongation_mask, mask);
-				inpaint_mask.setTo(false, mask);
+			auto size = imgs.front().size();
+			cv::Mat3f color(size);
+			cv::Mat1f quality_res(size);
+			cv::Mat1b depth_prolongation_mask_res(size);
+			cv::Mat1b inpaint_mask_res(size);
+
+			// Single pass: select the input with the highest quality (the first one for equal qualities) for each pixel
+#pragma omp parallel for
+			for (int y = 0; y < size.height; ++y) {
+				auto c = color.ptr<cv::Vec3f>(y);
+				auto q = quality_res.ptr<float>(y);
+				auto p = depth_prolongation_mask_res.ptr<uchar>(y);
+				auto m = inpaint_mask_res.ptr<uchar>(y);
+				for (int x = 0; x < size.width; ++x) {
+					auto best = -1;
+					auto best_quality = 0.f;
+					for (int i = 0; i < static_cast<int>(imgs.size()); ++i) {
+						auto candidate = qualities[i].ptr<float>(y)[x];
+						if (candidate > best_quality) {
+							best = i;
+							best_quality = candidate;
+						}
+					}
+					if (best < 0) {
+						c[x] = empty_color;
+						q[x] = 0.f;
+						p[x] = 0;
+						m[x] = true;
+					}
+					else {
+						c[x] = imgs[best].ptr<cv::Vec3f>(y)[x];
+						q[x] = best_quality;
+						p[x] = depth_prolongations[best].ptr<uchar>(y)[x];
+						m[x] = false;
+					}
+				}
 			}
 
+			quality = quality_res;
+			depth_prolongation_mask = depth_prolongation_mask_res;
+			inpaint_mask = inpaint_mask_res;
 			return color;
 		}
 
+		namespace
+		{
+			// Number of multiplications up to which an integer blending exponent is not computed with exp2 and log2
+			int const max_integer_exponent = 16;
+
+			// Blending weights quality^blending_exp of one row; only the weights of qualities > 0 are used
+			void blending_weights(const float* quality, float* weight, int n, float blending_exp)
+			{
+				if (blending_exp == std::floor(blending_exp) && blending_exp <= max_integer_exponent) {
+					auto exponent = static_cast<int>(blending_exp);
+					for (int x = 0; x < n; ++x) {
+						auto w = 1.f;
+						for (int k = 0; k < exponent; ++k) {
+							w *= quality[x];
+						}
+						weight[x] = w;
+					}
+				}
+				else {
+#if _OPENMP >= 201307
+#pragma omp simd
+#endif
+					for (int x = 0; x < n; ++x) {
+						weight[x] = quality[x] > 0.f ? std::exp2(blending_exp * std::log2(quality[x])) : 0.f;
+					}
+				}
+			}
+
+			// Inverse of blending_weights() for the blended quality: sum^(1 / blending_exp)
+			float blended_quality(float sum, float blending_exp)
+			{
+				if (blending_exp == 1.f) {
+					return sum;
+				}
+				if (blending_exp == 2.f) {
+					return std::sqrt(sum);
+				}
+				if (blending_exp == 0.f) {
+					// Mean: sum^inf, 1 for a single view
+					return powf(sum, 1.0f / blending_exp);
+				}
+				return std::exp2(std::log2(sum) / blending_exp);
+			}
+		}
+
 		cv::Mat blend_img(const std::vector<cv::Mat>& imgs, const std::vector<cv::Mat>& qualities, const std::vector<cv::Mat>& depth_prolongations, cv::Vec3f empty_color, cv::Mat& quality, cv::Mat& depth_prolongation_mask, cv::Mat& inpaint_mask, float blending_exp) {
 			if (blending_exp < 0)
 				return blend_img_by_max(imgs, qualities, depth_prolongations, empty_color, quality, depth_prolongation_mask, inpaint_mask);
-			cv::Mat res = cv::Mat::zeros(imgs[0].size(), CV_32FC3);
-			cv::Mat quality_res = cv::Mat::zeros(imgs[0].size(), CV_32F);
-			cv::Mat depth_prolongation_mask_res = cv::Mat::zeros(imgs[0].size(), depth_prolongation_mask.type());
-			cv::Mat inpaint_mask_res = (quality_res < -1.0);
-			for (int y = 0; y < res.rows; ++y)
-				for (int x = 0; x < res.cols; ++x) {
-					//computed from original depth
-					float s = 0.0;
-					//computed from prolongation of the depth map
-					cv::Vec3f inpainted_col = empty_color;
-					cv::Vec3f inpainted_depth_col(0, 0, 0);
-					cv::Vec3f col(0, 0, 0);
-					float inpainted_depth_s = 0.0;
-					for (int i = 0; i < static_cast<int>(imgs.size()); ++i) {
-						float a = qualities[i].at<float>(y, x);
-						bool valid_d = qualities[i].at<float>(y, x) > 0 && !depth_prolongations[i].at<bool>(y, x);
-						if (a > 0 && valid_d) {//priority to color computed from original depth
-							a = powf(a, blending_exp);
-							s += a;
-							col += a * imgs[i].at<cv::Vec3f>(y, x);
-						}
-						else {
-							if (a > 0 && qualities[i].at<float>(y, x) > 0) { //second priority to color computed from inpainted depth
-								a = powf(a, blending_exp);
-								inpainted_depth_s += a;
-								inpainted_depth_col += a * imgs[i].at<cv::Vec3f>(y, x);
+			auto size = imgs[0].size();
+			cv::Mat3f res(size);
+			cv::Mat1f quality_res(size);
+			cv::Mat1b depth_prolongation_mask_res(size);
+			cv::Mat1b inpaint_mask_res(size);
+
+			// Rows in parallel, with the sums of a row per thread
+#pragma omp parallel
+			{
+				std::vector<float> weight(size.width);
+				//computed from original depth
+				std::vector<float> s(size.width);
+				std::vector<cv::Vec3f> col(size.width);
+				//computed from prolongation of the depth map
+				std::vector<float> inpainted_depth_s(size.width);
+				std::vector<cv::Vec3f> inpainted_depth_col(size.width);
+
+#pragma omp for
+				for (int y = 0; y < size.height; ++y) {
+					std::fill(s.begin(), s.end(), 0.f);
+					std::fill(col.begin(), col.end(), cv::Vec3f::all(0.f));
+					std::fill(inpainted_depth_s.begin(), inpainted_depth_s.end(), 0.f);
+					std::fill(inpainted_depth_col.begin(), inpainted_depth_col.end(), cv::Vec3f::all(0.f));
+
+					for (std::size_t i = 0; i != imgs.size(); ++i) {
+						auto q = qualities[i].ptr<float>(y);
+						auto prolongation = depth_prolongations[i].ptr<uchar>(y);
+						auto c = imgs[i].ptr<cv::Vec3f>(y);
+						blending_weights(q, weight.data(), size.width, blending_exp);
+
+						for (int x = 0; x < size.width; ++x) {
+							if (q[x] > 0.f) {
+								if (!prolongation[x]) {//priority to color computed from original depth
+									s[x] += weight[x];
+									col[x] += weight[x] * c[x];
+								}
+								else {//second priority to color computed from inpainted depth
+									inpainted_depth_s[x] += weight[x];
+									inpainted_depth_col[x] += weight[x] * c[x];
+								}
 							}
 						}
 					}
-					if (s == 0) {
-						//no input image has a color at this pixel
-						if (inpainted_depth_s == 0.0) {
-							res.at<cv::Vec3f>(y, x) = inpainted_col;
-							inpaint_mask_res.at<bool>(y, x) = true;
-							depth_prolongation_mask_res.at<bool>(y, x) = true;
-							quality_res.at<float>(y, x) = 0.0;
+
+					auto r = res.ptr<cv::Vec3f>(y);
+					auto qr = quality_res.ptr<float>(y);
+					auto pr = depth_prolongation_mask_res.ptr<uchar>(y);
+					auto ir = inpaint_mask_res.ptr<uchar>(y);
+					for (int x = 0; x < size.width; ++x) {
+						//color comes from original depth in at least one image
+						if (s[x] != 0.f) {
+							r[x] = col[x] / s[x];
+							pr[x] = false;
+							ir[x] = false;
+							qr[x] = blended_quality(s[x], blending_exp);
+						}
+						//color comes from interpolated depth
+						else if (inpainted_depth_s[x] != 0.f) {
+							r[x] = inpainted_depth_col[x] / inpainted_depth_s[x];
+							pr[x] = true;
+							ir[x] = false;
+							qr[x] = blended_quality(inpainted_depth_s[x], blending_exp);
 						}
-						//color comes from interpolated depth 
+						//no input image has a color at this pixel
 						else {
-							res.at<cv::Vec3f>(y, x) = inpainted_depth_col / inpainted_depth_s;
-							depth_prolongation_mask_res.at<bool>(y, x) = true;
-							quality_res.at<float>(y, x) = powf(inpainted_depth_s, 1.0f / blending_exp);
+							r[x] = empty_color;
+							pr[x] = true;
+							ir[x] = true;
+							qr[x] = 0.f;
 						}
 					}
-					//color comes from original depth in at least one image
-					else {
-						res.at<cv::Vec3f>(y, x) = col / s;
-						depth_prolongation_mask_res.at<bool>(y, x) = false;
-						quality_res.at<float>(y, x) = powf(s, 1.0f / blending_exp);
-					}
 				}
+			}
 			inpaint_mask_res.copyTo(inpaint_mask);
 			depth_prolongation_mask = depth_prolongation_mask_res;
 			quality = quality_res;
 			return res;
 		}
 
-		void split_frequencies(const cv::Mat & img, cv::Mat & low_freq, cv::Mat & high_freq, const cv::Mat& mask)
+		cv::Mat pack_view(cv::Mat3f color, cv::Mat1f depth, cv::Mat1f quality, cv::Mat1f validity, cv::Mat1b depth_mask)
+		{
+			auto size = color.size();
+			CV_Assert(depth.size() == size && quality.size() == size && validity.size() == size && depth_mask.size() == size);
+			cv::Mat packed(size, CV_8UC(sizeof(PackedPixel)));
+
+#pragma omp parallel for
+			for (int y = 0; y < size.height; ++y) {
+				auto p = packed.ptr<PackedPixel>(y);
+				auto c = color.ptr<cv::Vec3f>(y);
+				auto d = depth.ptr<float>(y);
+				auto q = quality.ptr<float>(y);
+				auto v = validity.ptr<float>(y);
+				auto m = depth_mask.ptr<uchar>(y);
+				for (int x = 0; x < size.width; ++x) {
+					for (int k = 0; k != 3; ++k) {
+						p[x].color[k] = cv::float16_t(c[x][k]);
+					}
+					p[x].depth_mask = m[x];
+					p[x].reserved = 0;
+					p[x].depth = d[x];
+					p[x].quality = q[x];
+					p[x].validity = v[x];
+				}
+			}
+			return packed;
+		}
+
+		void unpack_view(cv::Mat packed, cv::Mat3f& color, cv::Mat1f& depth, cv::Mat1f& quality, cv::Mat1f& validity)
+		{
+			CV_Assert(packed.type() == CV_8UC(sizeof(PackedPixel)));
+			auto size = packed.size();
+			color.create(size);
+			depth.create(size);
+			quality.create(size);
+			validity.create(size);
+
+#pragma omp parallel for
+			for (int y = 0; y < size.height; ++y) {
+				auto p = packed.ptr<PackedPixel>(y);
+				auto c = color.ptr<cv::Vec3f>(y);
+				auto d = depth.ptr<float>(y);
+				auto q = quality.ptr<float>(y);
+				auto v = validity.ptr<float>(y);
+				for (int x = 0; x < size.width; ++x) {
+					c[x] = cv::Vec3f(float(p[x].color[0]), float(p[x].color[1]), float(p[x].color[2]));
+					d[x] = p[x].depth;
+					q[x] = p[x].quality;
+					v[x] = p[x].validity;
+				}
+			}
+		}
+
+		void blend_packed(cv::Mat packed, cv::Mat3f color, cv::Mat1f depth, cv::Mat1f quality, cv::Mat1f validity, cv::Vec3f empty_color, float blending_exp)
+		{
+			CV_Assert(packed.type() == CV_8UC(sizeof(PackedPixel)) && blending_exp >= 0.f);
+			auto size = packed.size();
+			CV_Assert(color.size() == size && depth.size() == size && quality.size() == size && validity.size() == size);
+
+			// Rows in parallel, with the qualities and weights of a row per thread
+#pragma omp parallel
+			{
+				std::vector<float> packed_quality(size.width);
+				std::vector<float> packed_weight(size.width);
+				std::vector<float> weight(size.width);
+
+#pragma omp for
+				for (int y = 0; y < size.height; ++y) {
+					auto p = packed.ptr<PackedPixel>(y);
+					auto c = color.ptr<cv::Vec3f>(y);
+					auto d = depth.ptr<float>(y);
+					auto q = quality.ptr<float>(y);
+					auto v = validity.ptr<float>(y);
+
+					for (int x = 0; x < size.width; ++x) {
+						packed_quality[x] = p[x].quality;
+					}
+					blending_weights(packed_quality.data(), packed_weight.data(), size.width, blending_exp);
+					blending_weights(q, weight.data(), size.width, blending_exp);
+
+					for (int x = 0; x < size.width; ++x) {
+						auto packed_color = cv::Vec3f(float(p[x].color[0]), float(p[x].color[1]), float(p[x].color[2]));
+
+						// Sums from original depth and from extrapolated depth, as in blend_img()
+						auto s = 0.f;
+						auto col = cv::Vec3f::all(0.f);
+						auto inpainted_depth_s = 0.f;
+						auto inpainted_depth_col = cv::Vec3f::all(0.f);
+						if (packed_quality[x] > 0.f) {
+							if (!p[x].depth_mask) {
+								s += packed_weight[x];
+								col += packed_weight[x] * packed_color;
+							}
+							else {
+								inpainted_depth_s += packed_weight[x];
+								inpainted_depth_col += packed_weight[x] * packed_color;
+							}
+						}
+						if (q[x] > 0.f) {
+							if (!(d[x] > 0.f)) {
+								s += weight[x];
+								col += weight[x] * c[x];
+							}
+							else {
+								inpainted_depth_s += weight[x];
+								inpainted_depth_col += weight[x] * c[x];
+							}
+						}
+
+						cv::Vec3f result;
+						if (s != 0.f) {
+							result = col / s;
+							p[x].depth_mask = false;
+							p[x].quality = blended_quality(s, blending_exp);
+						}
+						else if (inpainted_depth_s != 0.f) {
+							result = inpainted_depth_col / inpainted_depth_s;
+							p[x].depth_mask = true;
+							p[x].quality = blended_quality(inpainted_depth_s, blending_exp);
+						}
+						else {
+							result = empty_color;
+							p[x].depth_mask = true;
+							p[x].quality = 0.f;
+						}
+						for (int k = 0; k != 3; ++k) {
+							p[x].color[k] = cv::float16_t(result[k]);
+						}
+
+						// Depth of the best quality and maximum validity
+						if (q[x] > packed_quality[x]) {
+							p[x].depth = d[x];
+						}
+						p[x].validity = std::max(p[x].validity, v[x]);
+					}
+				}
+			}
+		}
+
+		int laplacian_pyramid_levels(cv::Size size)
+		{
+			auto levels = 1;
+			while (levels < 8 && std::min(size.width, size.height) >= 64) {
+				size = cv::Size((size.width + 1) / 2, (size.height + 1) / 2);
+				++levels;
+			}
+			return levels;
+		}
+
+		namespace
+		{
+			// Colors divided by their weights, or 0 without weight
+			cv::Mat3f normalize_colors(cv::Mat3f sum, cv::Mat1f weight)
+			{
+				cv::Mat3f result(sum.size());
+#pragma omp parallel for
+				for (int y = 0; y < sum.rows; ++y) {
+					auto s = sum.ptr<cv::Vec3f>(y);
+					auto w = weight.ptr<float>(y);
+					auto r = result.ptr<cv::Vec3f>(y);
+					for (int x = 0; x < sum.cols; ++x) {
+						r[x] = w[x] > 0.f ? s[x] / w[x] : cv::Vec3f::all(0.f);
+					}
+				}
+				return result;
+			}
+		}
+
+		void accumulate_laplacian_pyramid(cv::Mat3f color, cv::Mat1f weight, int levels, std::vector<cv::Mat3f>& bands, std::vector<cv::Mat1f>& weights)
+		{
+			// Gaussian pyramids of the weights and of the weighted colors
+			std::vector<cv::Mat1f> weight_pyramid(levels);
+			std::vector<cv::Mat3f> color_pyramid(levels);
+			weight_pyramid[0] = weight;
+			color_pyramid[0] = cv::Mat3f(color.size());
+#pragma omp parallel for
+			for (int y = 0; y < color.rows; ++y) {
+				auto c = color.ptr<cv::Vec3f>(y);
+				auto w = weight.ptr<float>(y);
+				auto r = color_pyramid[0].ptr<cv::Vec3f>(y);
+				for (int x = 0; x < color.cols; ++x) {
+					r[x] = w[x] > 0.f ? w[x] * c[x] : cv::Vec3f::all(0.f);
+				}
+			}
+			for (int l = 1; l < levels; ++l) {
+				cv::pyrDown(weight_pyramid[l - 1], weight_pyramid[l]);
+				cv::pyrDown(color_pyramid[l - 1], color_pyramid[l]);
+			}
+			for (int l = 0; l < levels; ++l) {
+				color_pyramid[l] = normalize_colors(color_pyramid[l], weight_pyramid[l]);
+			}
+
+			if (bands.empty()) {
+				bands.resize(levels);
+				weights.resize(levels);
+				for (int l = 0; l < levels; ++l) {
+					bands[l] = cv::Mat3f::zeros(weight_pyramid[l].size());
+					weights[l] = cv::Mat1f::zeros(weight_pyramid[l].size());
+				}
+			}
+			CV_Assert(static_cast<int>(bands.size()) == levels && bands[0].size() == color.size());
+
+			// Bands: the difference with the expanded coarser level, and the coarsest level itself
+			for (int l = 0; l < levels; ++l) {
+				cv::Mat3f expanded;
+				if (l + 1 < levels) {
+					cv::pyrUp(color_pyramid[l + 1], expanded, color_pyramid[l].size());
+				}
+				auto& sum = bands[l];
+				auto& total = weights[l];
+#pragma omp parallel for
+				for (int y = 0; y < sum.rows; ++y) {
+					auto g = color_pyramid[l].ptr<cv::Vec3f>(y);
+					auto e = expanded.empty() ? nullptr : expanded.ptr<cv::Vec3f>(y);
+					auto w = weight_pyramid[l].ptr<float>(y);
+					auto s = sum.ptr<cv::Vec3f>(y);
+					auto t = total.ptr<float>(y);
+					for (int x = 0; x < sum.cols; ++x) {
+						if (w[x] > 0.f) {
+							s[x] += w[x] * (e ? g[x] - e[x] : g[x]);
+							t[x] += w[x];
+						}
+					}
+				}
+			}
+		}
+
+		cv::Mat3f collapse_laplacian_pyramid(std::vector<cv::Mat3f> const& bands, std::vector<cv::Mat1f> const& weights, cv::Vec3f empty_color)
+		{
+			auto levels = static_cast<int>(bands.size());
+			cv::Mat3f result = normalize_colors(bands[levels - 1], weights[levels - 1]);
+			for (int l = levels - 2; l >= 0; --l) {
+				cv::Mat3f expanded;
+				cv::pyrUp(result, expanded, bands[l].size());
+				cv::add(normalize_colors(bands[l], weights[l]), expanded, result);
+			}
+			result.setTo(empty_color, weights[0] <= 0.f);
+			return result;
+		}
+
+		void split_frequencies(const cv::Mat & img, cv::Mat & low_freq, cv::Mat & high_freq, const cv::Mat& mask, ColorSpace color_space)
+		{
+			MaskedBoxBlur blur;
+			split_frequencies(img, low_freq, high_freq, mask, color_space, blur);
+		}
+
+		void split_frequencies(const cv::Mat & img, cv::Mat & low_freq, cv::Mat & high_freq, const cv::Mat& mask, ColorSpace color_space, MaskedBoxBlur& blur)
 		{
 			int kernel_size = ((int)MAX(img.rows, img.cols) / 20);
 			//RGB: blur all three channels
-			if (g_color_space == ColorSpace::RGB) {
+			if (color_space == ColorSpace::RGB) {
 				cv::Mat img_rgb_blurry;
 
-				calcBlurring(img, low_freq, mask, kernel_size);
+				blur.apply(img, mask, kernel_size, low_freq);
 
 				high_freq = img - low_freq;
 			}
 			//YCrCb: blur only Y channel
-			else if (g_color_space == ColorSpace::YUV) {
+			else if (color_space == ColorSpace::YUV) {
 				CV_DbgAssert(img.channels() == 3);
 				cv::Mat chans[3];
 				cv::split(img, chans);
 
-				calcBlurring(chans[0], chans[0], mask, kernel_size);
+				blur.apply(chans[0], mask, kernel_size, chans[0]);
 
 				cv::merge(chans, 3, low_freq);
 
@@ -45,8 +45,12 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #ifndef _BLENDING_HPP_
 #define _BLENDING_HPP_
 
+#include "Context.hpp"
+
 #include <opencv2/core.hpp>
 
+#include <vector>
+
 /**
 @file blending.hpp
 \brief The file containing the image blending functions
@@ -72,6 +76,31 @@ namespace rvs
 		*/
 		cv::Mat blend_img_by_max(const std::vector<cv::Mat>& imgs, const std::vector<cv::Mat>& qualities, const std::vector<cv::Mat>& depth_prolongations, cv::Vec3f empty_color, cv::Mat& quality, cv::Mat& depth_prolongation_mask, cv::Mat& inpaint_mask);
 
+		/**
+		\brief Masked mean blur with a square window, with buffers that are reused from one image to the next
+
+		The blur is separable: running sums over the rows and then over the columns, such that the cost per pixel does not
+		depend on the radius. Rows and column strips are processed in parallel.
+		*/
+		class MaskedBoxBlur
+		{
+		public:
+			/**
+			\brief Blur an image
+
+			@param img Image to blur, CV_32FC1 or CV_32FC3
+			@param mask Pixels to include (255) in the mean; where the mask is 0 the result is 0. Pixels which are not finite are not included either
+			@param radius Half the width of the window: (2 radius + 1) x (2 radius + 1) pixels, clipped at the image borders
+			@param[out] blurred Mean of the included pixels within the window (may be img)
+			*/
+			void apply(cv::Mat img, cv::Mat1b mask, int radius, cv::Mat& blurred);
+
+		private:
+			// Sums over the rows, and number of included pixels (repeated for each channel)
+			cv::Mat1f m_sum;
+			cv::Mat1f m_count;
+		};
+
 		/**
 		 * \brief Split an image in low and high frequency.
 
@@ -80,8 +109,14 @@ namespace rvs
 		 * @param low_freq Output containing the low frequency part of the image
 		 * @param high_freq Output containing the high frequency part of the image
 		 * @param mask Mask for part of the image to ignore
+		 * @param color_space Working color space: in YUV only the luma channel is blurred
+		 * */
+		void split_frequencies(const cv::Mat & img, cv::Mat& low_freq, cv::Mat& high_freq, const cv::Mat& mask, ColorSpace color_space);
+
+		/**
+		 * \brief Split an image in low and high frequency, reusing the buffers of the blur (see split_frequencies())
 		 * */
-		void split_frequencies(const cv::Mat & img, cv::Mat& low_freq, cv::Mat& high_freq, const cv::Mat& mask);
+		void split_frequencies(const cv::Mat & img, cv::Mat& low_freq, cv::Mat& high_freq, const cv::Mat& mask, ColorSpace color_space, MaskedBoxBlur& blur);
 
 		/**
 		\brief Blend an array of color images by weigthed mean with quality of the pixels.
@@ -103,6 +138,80 @@ namespace rvs
 		@return Color image containing the the weighted mean of the input images.
 		*/
 		cv::Mat blend_img(const std::vector<cv::Mat>& imgs, const std::vector<cv::Mat>& qualities, const std::vector<cv::Mat>& depth_prolongations, cv::Vec3f empty_color, cv::Mat& quality, cv::Mat& depth_prolongation_mask, cv::Mat& inpaint_mask, float blending_exp);
+
+		/**
+		\brief Pixel of a packed view: the maps of a view interleaved, such that a pixel is read and written as one unit
+
+		The color is stored in half precision, which is exact to about 11 bits (enough for 10-bit video). A packed view is a
+		cv::Mat of type CV_8UC(sizeof(PackedPixel)), accessed with ptr<PackedPixel>().
+		*/
+		struct PackedPixel
+		{
+			cv::float16_t color[3];
+			uchar depth_mask; ///< Depth mask of the blending (see depth_prolongations of blend_img())
+			uchar reserved;
+			float depth;
+			float quality;
+			float validity;
+		};
+
+		/**
+		\brief Interleave the maps of a view into a packed view (see PackedPixel)
+		*/
+		cv::Mat pack_view(cv::Mat3f color, cv::Mat1f depth, cv::Mat1f quality, cv::Mat1f validity, cv::Mat1b depth_mask);
+
+		/**
+		\brief Split a packed view into its maps (see PackedPixel)
+		*/
+		void unpack_view(cv::Mat packed, cv::Mat3f& color, cv::Mat1f& depth, cv::Mat1f& quality, cv::Mat1f& validity);
+
+		/**
+		\brief Blend a view into a packed view, in place, in a single pass
+
+		Same result as blend_img() with two images followed by the selection of the depth of the best quality and the maximum of
+		the validities, up to the rounding of the color to half precision. The depth mask of the view is its depth > 0.
+
+		@param[in,out] packed Blended packed view (see PackedPixel)
+		@param color Color of the view to add
+		@param depth Depth of the view to add
+		@param quality Quality of the view to add
+		@param validity Validity of the view to add
+		@param empty_color Color for unknown pixels
+		@param blending_exp Blending exponent (>= 0)
+		*/
+		void blend_packed(cv::Mat packed, cv::Mat3f color, cv::Mat1f depth, cv::Mat1f quality, cv::Mat1f validity, cv::Vec3f empty_color, float blending_exp);
+
+		/**
+		\brief Number of levels of the Laplacian pyramids of an image for multi-band blending
+
+		The coarsest level is at least 32 pixels wide and high (or the image itself when it is smaller), with at most 8 levels.
+		*/
+		int laplacian_pyramid_levels(cv::Size size);
+
+		/**
+		\brief Add the Laplacian pyramid of a color image to the weighted sums of bands of multi-band blending
+
+		The Gaussian pyramid of the weights is built with cv::pyrDown() (5-tap binomial filter). The colors are normalized by the
+		weights at each level before the bands are computed, such that pixels without weight do not bleed into the bands.
+		Each band is accumulated with the weights of its level.
+
+		@param color Color image
+		@param weight Blending weights of the pixels (0 where the color is unknown)
+		@param levels Number of levels (see laplacian_pyramid_levels())
+		@param[in,out] bands Weighted sums of the bands per level (allocated and zero when empty)
+		@param[in,out] weights Sums of the weights per level (allocated and zero when empty)
+		*/
+		void accumulate_laplacian_pyramid(cv::Mat3f color, cv::Mat1f weight, int levels, std::vector<cv::Mat3f>& bands, std::vector<cv::Mat1f>& weights);
+
+		/**
+		\brief Normalize the sums of bands of accumulate_laplacian_pyramid() and collapse them to the blended color image
+
+		@param bands Weighted sums of the bands per level
+		@param weights Sums of the weights per level
+		@param empty_color Color for pixels without weight
+		@return Blended color image
+		*/
+		cv::Mat3f collapse_laplacian_pyramid(std::vector<cv::Mat3f> const& bands, std::vector<cv::Mat1f> const& weights, cv::Vec3f empty_color);
 	}
 }
 
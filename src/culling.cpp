@@ -0,0 +1,210 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+#include "culling.hpp"
+#include "SpaceTransformer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace rvs
+{
+	namespace detail
+	{
+		namespace
+		{
+			// Number of grid steps over the angular range of an equirectangular input view
+			int const erpGridSteps = 16;
+
+			// A half-space n.x >= 0 that contains the virtual frustum
+			typedef cv::Vec3f HalfSpace;
+
+			std::vector<cv::Vec3f> boundPerspective(Parameters const& input)
+			{
+				auto f = input.getFocal();
+				auto p = input.getPrinciplePoint();
+				auto size = input.getSize();
+				auto depth_range = input.getDepthRange();
+
+				std::vector<cv::Vec3f> points;
+				for (auto d : { depth_range[0], depth_range[1] }) {
+					for (auto u : { 0.f, float(size.width) }) {
+						for (auto v : { 0.f, float(size.height) }) {
+							// Same as PerspectiveUnprojector::unproject
+							points.emplace_back(
+								d,
+								-(d / f[0]) * (u - p[0]),
+								-(d / f[1]) * (v - p[1]));
+						}
+					}
+				}
+				return points;
+			}
+
+			std::vector<cv::Vec3f> boundEquirectangular(Parameters const& input)
+			{
+				auto hor_range = input.getHorRange();
+				auto ver_range = input.getVerRange();
+
+				auto const radperdeg = 0.01745329252f;
+				auto dphi = radperdeg * (hor_range[1] - hor_range[0]) / erpGridSteps;
+				auto dtheta = radperdeg * (ver_range[1] - ver_range[0]) / erpGridSteps;
+
+				// Any direction in the range is within a cell diagonal of a grid direction. Enlarging the radius
+				// accordingly makes the convex hull contain the spherical sector.
+				auto diagonal = std::sqrt(dphi * dphi + dtheta * dtheta);
+				auto radius = input.getDepthRange()[1] / std::cos(std::min(diagonal, 1.f));
+
+				std::vector<cv::Vec3f> points{ cv::Vec3f::all(0.f) };
+				for (int i = 0; i <= erpGridSteps; ++i) {
+					auto theta = radperdeg * ver_range[0] + i * dtheta;
+					for (int j = 0; j <= erpGridSteps; ++j) {
+						auto phi = radperdeg * hor_range[0] + j * dphi;
+						points.push_back(radius * cv::Vec3f(
+							std::cos(theta) * std::cos(phi),
+							std::cos(theta) * std::sin(phi),
+							std::sin(theta)));
+					}
+				}
+				return points;
+			}
+
+			std::vector<HalfSpace> perspectiveFrustum(Parameters const& camera)
+			{
+				auto f = camera.getFocal();
+				auto p = camera.getPrinciplePoint();
+				auto size = camera.getSize();
+
+				// Same as PerspectiveProjector::project: u = -f[0] y/x + p[0] in [0, width], v = -f[1] z/x + p[1] in [0, height]
+				return{
+					HalfSpace(1.f, 0.f, 0.f),
+					HalfSpace(p[0], -f[0], 0.f),
+					HalfSpace(size.width - p[0], f[0], 0.f),
+					HalfSpace(p[1], 0.f, -f[1]),
+					HalfSpace(size.height - p[1], 0.f, f[1]) };
+			}
+
+			std::vector<HalfSpace> equirectangularRange(Parameters const& camera)
+			{
+				auto hor_range = camera.getHorRange();
+				auto ver_range = camera.getVerRange();
+				auto const radperdeg = 0.01745329252f;
+
+				std::vector<HalfSpace> planes;
+
+				// A horizontal range up to 180 degrees is the intersection of two half-spaces
+				if (hor_range[1] - hor_range[0] <= 180.f) {
+					auto phi0 = radperdeg * hor_range[0];
+					auto phi1 = radperdeg * hor_range[1];
+					planes.emplace_back(-std::sin(phi0), std::cos(phi0), 0.f);
+					planes.emplace_back(std::sin(phi1), -std::cos(phi1), 0.f);
+				}
+
+				// A vertical range that does not cross the horizon is within a half-space
+				if (ver_range[0] >= 0.f) {
+					planes.emplace_back(0.f, 0.f, 1.f);
+				}
+				if (ver_range[1] <= 0.f) {
+					planes.emplace_back(0.f, 0.f, -1.f);
+				}
+				return planes;
+			}
+		}
+
+		std::vector<cv::Vec3f> boundInputView(Parameters const& input)
+		{
+			if (input.getProjectionType() == ProjectionType::perspective) {
+				return boundPerspective(input);
+			}
+			if (input.getProjectionType() == ProjectionType::equirectangular) {
+				return boundEquirectangular(input);
+			}
+			std::ostringstream what;
+			what << "Unknown projection type \"" << input.getProjectionType() << "\"";
+			throw std::runtime_error(what.str());
+		}
+
+		bool isOverlapping(Parameters const& input, Parameters const& virtualCamera)
+		{
+			// Polynomial displacement does not have a bounded geometry
+			if (input.getDisplacementMethod() != DisplacementMethod::depth) {
+				return true;
+			}
+
+			SpaceTransformer transformer;
+			transformer.set_inputPosition(&input);
+			transformer.set_targetPosition(&virtualCamera);
+			auto R = transformer.get_rotation();
+			auto t = transformer.get_translation();
+
+			auto points = boundInputView(input);
+			for (auto& point : points) {
+				point = R * point + t;
+			}
+
+			auto planes = virtualCamera.getProjectionType() == ProjectionType::perspective
+				? perspectiveFrustum(virtualCamera)
+				: equirectangularRange(virtualCamera);
+
+			// The input view is culled when all its points are strictly outside one of the half-spaces
+			for (auto const& plane : planes) {
+				auto outside = true;
+				for (auto const& point : points) {
+					if (plane.dot(point) >= 0.f) {
+						outside = false;
+						break;
+					}
+				}
+				if (outside) {
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+}
@@ -0,0 +1,91 @@
+/* The copyright in this software is being made available under the BSD
+* License, included below. This software may be subject to other third party
+* and contributor rights, including patent rights, and no such rights are
+* granted under this license.
+*
+* Copyright (c) 2010-2018, ITU/ISO/IEC
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+*  * Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*  * Redistributions in binary form must reproduce the above copyright notice,
+*    this list of conditions and the following disclaimer in the documentation
+*    and/or other materials provided with the distribution.
+*  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+*    be used to endorse or promote products derived from this software without
+*    specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+* THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+Original authors:
+
+Universite Libre de Bruxelles, Brussels, Belgium:
+  Sarah Fachada, Sarah.Fernandes.Pinto.Fachada@ulb.ac.be
+  Daniele Bonatto, Daniele.Bonatto@ulb.ac.be
+  Arnaud Schenkel, arnaud.schenkel@ulb.ac.be
+
+Koninklijke Philips N.V., Eindhoven, The Netherlands:
+  Bart Kroon, bart.kroon@philips.com
+  Bart Sonneveldt, bart.sonneveldt@philips.com
+*/
+
+#ifndef _CULLING_HPP_
+#define _CULLING_HPP_
+
+#include "Parameters.hpp"
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+
+namespace rvs
+{
+	namespace detail
+	{
+		/**
+		@file culling.hpp
+		\brief The file containing the input view culling functions
+		*/
+
+		/**
+		\brief Points of which the convex hull contains all points that an input view can unproject to
+
+		For perspective input views, these are the corners of the frustum between the near and far depth. For equirectangular input views,
+		these are the camera center and a grid of directions over the angular range at a slightly enlarged far radius.
+
+		@param input Input camera parameters
+		@return Bounding points in the coordinate system of the input camera
+		*/
+		std::vector<cv::Vec3f> boundInputView(Parameters const& input);
+
+		/**
+		\brief Test if an input view can contribute to a virtual view
+
+		The bound of the input view (see boundInputView()) is transformed to the virtual camera and tested against the planes of the
+		virtual frustum (perspective) or of the horizontal and vertical angular range (equirectangular). The test is conservative: when
+		it returns false, no pixel of the input view projects within the virtual view.
+
+		@param input Input camera parameters
+		@param virtualCamera Virtual camera parameters
+		@return false if the input view cannot contribute to the virtual view
+		*/
+		bool isOverlapping(Parameters const& input, Parameters const& virtualCamera);
+	}
+}
+
+#endif
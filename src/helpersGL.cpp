@@ -48,6 +48,7 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "RFBO.hpp"
 #include "Shader.hpp"
 
+#include <stdexcept>
 #include <string>
 
 #include "gl_core_4.5.hpp"
@@ -63,14 +64,36 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#if WITH_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
 #include <GL/glx.h>
 #include <X11/Xlib.h>
 #endif
+#endif
 
 namespace rvs
 {
 	namespace opengl
 	{
+		namespace
+		{
+			// Texture formats for the number of channels of an image
+			void texture_formats(const cv::Mat& img, GLenum& internalformat, GLenum& externalformat)
+			{
+				internalformat = GL_RGB32F;
+				if (img.channels() == 4) internalformat = GL_RGBA32F;
+				if (img.channels() == 3) internalformat = GL_RGB;
+				if (img.channels() == 2) internalformat = GL_RG;
+				if (img.channels() == 1) internalformat = GL_R32F;
+
+				externalformat = GL_BGR;
+				if (img.channels() == 1) externalformat = GL_RED; // GL_DEPTH_COMPONENT32, GL_DEPTH_COMPONENT32F, GL_R32F NOT WORKING!
+				if (img.channels() == 4) externalformat = GL_RGBA; // GL_DEPTH_COMPONENT32, GL_DEPTH_COMPONENT32F, GL_R32F NOT WORKING!
+			}
+		}
+
 		GLuint cvMat2glTexture(const cv::Mat& mat)
 		{
 			// https://stackoverflow.com/questions/16809833/opencv-image-loading-for-opengl-texture
@@ -92,15 +115,8 @@ namespace rvs
 																		//set length of one complete row in data (doesn't need to equal image.cols)
 			glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(img.step / img.elemSize()));
 
-			GLenum internalformat = GL_RGB32F;
-			if (img.channels() == 4) internalformat = GL_RGBA32F;
-			if (img.channels() == 3) internalformat = GL_RGB;
-			if (img.channels() == 2) internalformat = GL_RG;
-			if (img.channels() == 1) internalformat = GL_R32F;
-
-			GLenum externalformat = GL_BGR;
-			if (img.channels() == 1) externalformat = GL_RED; // GL_DEPTH_COMPONENT32, GL_DEPTH_COMPONENT32F, GL_R32F NOT WORKING!
-			if (img.channels() == 4) externalformat = GL_RGBA; // GL_DEPTH_COMPONENT32, GL_DEPTH_COMPONENT32F, GL_R32F NOT WORKING!
+			GLenum internalformat, externalformat;
+			texture_formats(img, internalformat, externalformat);
 
 			GLuint texture;
 			glGenTextures(1, &texture);
@@ -136,6 +152,297 @@ namespace rvs
 			return texture;
 		}
 
+		PixelBufferRing::PixelBufferRing(GLenum target, int count)
+			: m_target(target)
+			, m_buffers(count, 0)
+			, m_sizes(count, 0)
+			, m_fences(count, nullptr)
+		{}
+
+		PixelBufferRing::~PixelBufferRing()
+		{
+			for (auto i = 0u; i != m_buffers.size(); ++i) {
+				if (m_fences[i]) {
+					glDeleteSync(m_fences[i]);
+				}
+				if (m_buffers[i]) {
+					glDeleteBuffers(1, &m_buffers[i]);
+				}
+			}
+		}
+
+		int PixelBufferRing::acquire(GLsizeiptr size)
+		{
+			auto slot = m_next;
+			m_next = (m_next + 1) % static_cast<int>(m_buffers.size());
+			wait(slot);
+
+			if (!m_buffers[slot]) {
+				glGenBuffers(1, &m_buffers[slot]);
+			}
+			glBindBuffer(m_target, m_buffers[slot]);
+			if (m_sizes[slot] < size) {
+				glBufferData(m_target, size, nullptr, m_target == GL_PIXEL_PACK_BUFFER ? GL_STREAM_READ : GL_STREAM_DRAW);
+				m_sizes[slot] = size;
+			}
+			return slot;
+		}
+
+		void PixelBufferRing::fence(int slot)
+		{
+			if (m_fences[slot]) {
+				glDeleteSync(m_fences[slot]);
+			}
+			m_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		void PixelBufferRing::wait(int slot)
+		{
+			if (!m_fences[slot]) {
+				return;
+			}
+			GLenum status;
+			do {
+				status = glClientWaitSync(m_fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(1000000)); // 1 ms
+			} while (status == GL_TIMEOUT_EXPIRED);
+			glDeleteSync(m_fences[slot]);
+			m_fences[slot] = nullptr;
+			if (status == GL_WAIT_FAILED) {
+				throw std::runtime_error("Waiting for a pixel buffer transfer failed");
+			}
+		}
+
+		void PixelBufferRing::bind(int slot) const
+		{
+			glBindBuffer(m_target, m_buffers[slot]);
+		}
+
+		GpuTimer::GpuTimer(int number_of_stages)
+			: m_number_of_stages(number_of_stages)
+		{}
+
+		GpuTimer::~GpuTimer()
+		{
+			for (auto& queries : m_queries) {
+				for (auto& query : queries) {
+					m_free.push_back(query.second);
+				}
+			}
+			for (auto& query : m_late) {
+				m_free.push_back(query.second);
+			}
+			if (!m_free.empty()) {
+				glDeleteQueries(GLsizei(m_free.size()), m_free.data());
+			}
+		}
+
+		void GpuTimer::begin(int stage)
+		{
+			if (m_active) {
+				throw std::logic_error("GPU timer stages cannot be nested");
+			}
+			GLuint query;
+			if (m_free.empty()) {
+				glGenQueries(1, &query);
+			}
+			else {
+				query = m_free.back();
+				m_free.pop_back();
+			}
+			m_queries[m_current].emplace_back(stage, query);
+			glBeginQuery(GL_TIME_ELAPSED, query);
+			m_active = true;
+		}
+
+		void GpuTimer::end()
+		{
+			if (!m_active) {
+				throw std::logic_error("No GPU timer stage to end");
+			}
+			glEndQuery(GL_TIME_ELAPSED);
+			m_active = false;
+		}
+
+		std::vector<double> GpuTimer::end_frame()
+		{
+			if (m_active) {
+				end();
+			}
+
+			// The previous frame was issued a frame ago: its results are usually available
+			auto previous = 1 - m_current;
+			auto times = collect(previous, false);
+			m_current = previous;
+			return times;
+		}
+
+		std::vector<double> GpuTimer::flush()
+		{
+			return collect(1 - m_current, true);
+		}
+
+		std::vector<double> GpuTimer::collect(int buffer, bool wait)
+		{
+			auto& queries = m_queries[buffer];
+			queries.insert(queries.end(), m_late.begin(), m_late.end());
+			m_late.clear();
+			if (queries.empty()) {
+				return std::vector<double>();
+			}
+			std::vector<double> times(m_number_of_stages, 0.);
+			for (auto& query : queries) {
+				if (!wait) {
+					GLuint available = GL_FALSE;
+					glGetQueryObjectuiv(query.second, GL_QUERY_RESULT_AVAILABLE, &available);
+					if (!available) {
+						m_late.push_back(query);
+						continue;
+					}
+				}
+				GLuint64 nanoseconds = 0;
+				glGetQueryObjectui64v(query.second, GL_QUERY_RESULT, &nanoseconds);
+				times[query.first] += 1e-6 * double(nanoseconds);
+				m_free.push_back(query.second);
+			}
+			queries.clear();
+			return times;
+		}
+
+		ResourceCache::ResourceCache()
+			: m_uploads(GL_PIXEL_UNPACK_BUFFER, 3)
+		{}
+
+		ResourceCache::~ResourceCache()
+		{
+			for (auto& texture : m_textures) {
+				glDeleteTextures(1, &texture.second);
+			}
+			for (auto& texture : m_texture_arrays) {
+				glDeleteTextures(1, &texture.second);
+			}
+			for (auto& buffer : m_uniform_buffers) {
+				glDeleteBuffers(1, &buffer.second);
+			}
+			if (m_quad_vao) {
+				glDeleteVertexArrays(1, &m_quad_vao);
+				glDeleteBuffers(1, &m_quad_vbo);
+			}
+		}
+
+		VAO_VBO_EBO const& ResourceCache::mesh(cv::Size size)
+		{
+			auto& mesh = m_meshes[std::make_pair(size.width, size.height)];
+			if (!mesh) {
+				mesh.reset(new VAO_VBO_EBO(size));
+			}
+			return *mesh;
+		}
+
+		GLuint ResourceCache::texture(const cv::Mat& mat, int unit)
+		{
+			auto key = std::make_tuple(mat.cols, mat.rows, mat.type(), unit);
+			auto it = m_textures.find(key);
+			if (it == m_textures.end()) {
+				auto texture = cvMat2glTexture(mat);
+				m_textures[key] = texture;
+				return texture;
+			}
+
+			// Same size and format: stream the data through a pixel buffer, the copy into the texture is asynchronous
+			GLenum internalformat, externalformat;
+			texture_formats(mat, internalformat, externalformat);
+			auto size = static_cast<GLsizeiptr>(mat.total() * mat.elemSize());
+			auto slot = m_uploads.acquire(size);
+			auto data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+			mat.copyTo(cv::Mat(mat.size(), mat.type(), data));
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+			glBindTexture(GL_TEXTURE_2D, it->second);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, mat.cols, mat.rows, externalformat, GL_FLOAT, nullptr);
+			m_uploads.fence(slot);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			return it->second;
+		}
+
+		GLuint ResourceCache::texture_array(std::vector<cv::Mat> const& mats, int unit)
+		{
+			auto const& first = mats.front();
+			GLenum internalformat, externalformat;
+			texture_formats(first, internalformat, externalformat);
+
+			auto key = std::make_tuple(first.cols, first.rows, first.type(), unit, static_cast<int>(mats.size()));
+			auto& texture = m_texture_arrays[key];
+			if (!texture) {
+				glGenTextures(1, &texture);
+				glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalformat, first.cols, first.rows, GLsizei(mats.size()), 0, externalformat, GL_FLOAT, nullptr);
+			}
+
+			// Stream each layer through a pixel buffer
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+			for (int layer = 0; layer != static_cast<int>(mats.size()); ++layer) {
+				auto const& mat = mats[layer];
+				if (mat.size() != first.size() || mat.type() != first.type()) {
+					throw std::logic_error("The layers of an array texture should have the same size and type");
+				}
+				auto size = static_cast<GLsizeiptr>(mat.total() * mat.elemSize());
+				auto slot = m_uploads.acquire(size);
+				auto data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+				mat.copyTo(cv::Mat(mat.size(), mat.type(), data));
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, mat.cols, mat.rows, 1, externalformat, GL_FLOAT, nullptr);
+				m_uploads.fence(slot);
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			return texture;
+		}
+
+		GLuint ResourceCache::quad()
+		{
+			if (!m_quad_vao) {
+				GLfloat quadVertices[] = {
+					-1.0f, 1.0f, 0.0f, 1.0f,
+					-1.0f, -1.0f, 0.0f, 0.0f,
+					1.0f, -1.0f, 1.0f, 0.0f,
+					-1.0f, 1.0f, 0.0f, 1.0f,
+					1.0f, -1.0f, 1.0f, 0.0f,
+					1.0f, 1.0f, 1.0f, 1.0f };
+				glGenVertexArrays(1, &m_quad_vao);
+				glGenBuffers(1, &m_quad_vbo);
+				glBindVertexArray(m_quad_vao);
+				glBindBuffer(GL_ARRAY_BUFFER, m_quad_vbo);
+				glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+				glEnableVertexAttribArray(0);
+				glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE,
+					4 * sizeof(GLfloat), (GLvoid*)0);
+				glEnableVertexAttribArray(1);
+				glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE,
+					4 * sizeof(GLfloat), (GLvoid*)(2 * sizeof(GLfloat)));
+				glBindVertexArray(0);
+			}
+			return m_quad_vao;
+		}
+
+		void ResourceCache::uniform_buffer(GLuint binding, const void* data, GLsizeiptr size)
+		{
+			auto& buffer = m_uniform_buffers[binding];
+			if (!buffer) {
+				glGenBuffers(1, &buffer);
+			}
+			glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+			glBufferData(GL_UNIFORM_BUFFER, size, data, GL_STREAM_DRAW);
+			glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+
 		// END OpenGL Utilities
 
 
@@ -380,6 +687,70 @@ namespace rvs
 
 			return window;
 		}
+#elif WITH_EGL // linux, headless
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+		void create_opengl_context()
+		{
+			/* Display without window system: the surfaceless platform (Mesa, e.g. llvmpipe), or else the default display
+			 (e.g. the GPU of a headless server with the NVIDIA driver) */
+			auto eglGetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+			if (eglGetPlatformDisplayEXT) {
+				context_NO_WRITE.disp = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+			}
+			EGLint major = 0, minor = 0;
+			if (context_NO_WRITE.disp == EGL_NO_DISPLAY || !eglInitialize(context_NO_WRITE.disp, &major, &minor)) {
+				/* No surfaceless platform, or it cannot be initialized (e.g. no Mesa driver for the GPU) */
+				context_NO_WRITE.disp = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+				if (context_NO_WRITE.disp != EGL_NO_DISPLAY && !eglInitialize(context_NO_WRITE.disp, &major, &minor)) {
+					context_NO_WRITE.disp = EGL_NO_DISPLAY;
+				}
+			}
+			if (context_NO_WRITE.disp == EGL_NO_DISPLAY) {
+				printf("eglInitialize() failed\n");
+				exit(1);
+			}
+			if (!eglBindAPI(EGL_OPENGL_API)) {
+				printf("eglBindAPI() failed: no desktop OpenGL\n");
+				exit(1);
+			}
+
+			static EGLint const config_attribs[] = {
+				EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+				EGL_RED_SIZE, 1,
+				EGL_GREEN_SIZE, 1,
+				EGL_BLUE_SIZE, 1,
+				EGL_NONE
+			};
+			EGLConfig config;
+			EGLint num_config = 0;
+			if (!eglChooseConfig(context_NO_WRITE.disp, config_attribs, &config, 1, &num_config) || num_config == 0) {
+				printf("eglChooseConfig() failed\n");
+				exit(1);
+			}
+
+			/* Same minimum OpenGL version as with GLX */
+			static EGLint const context_attribs[] = {
+				EGL_CONTEXT_MAJOR_VERSION, 4,
+				EGL_CONTEXT_MINOR_VERSION, 2,
+				EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+				EGL_NONE
+			};
+			context_NO_WRITE.ctx = eglCreateContext(context_NO_WRITE.disp, config, EGL_NO_CONTEXT, context_attribs);
+			if (context_NO_WRITE.ctx == EGL_NO_CONTEXT) {
+				printf("Failed to create OpenGL context. Exiting.\n");
+				exit(1);
+			}
+
+			/* No surface: all rendering is to frame buffer objects (EGL_KHR_surfaceless_context) */
+			if (!eglMakeCurrent(context_NO_WRITE.disp, EGL_NO_SURFACE, EGL_NO_SURFACE, context_NO_WRITE.ctx)) {
+				printf("eglMakeCurrent() failed: no surfaceless context\n");
+				exit(1);
+			}
+			printf("EGL %d.%d context created.\nVendor %s\n", major, minor, eglQueryString(context_NO_WRITE.disp, EGL_VENDOR));
+		}
 #else // linux
 		// Inspired by http://apoorvaj.io/creating-a-modern-opengl-context.html
 		typedef GLXContext(*glXCreateContextAttribsARBProc) (Display*, GLXFBConfig, GLXContext, Bool, const int*);
@@ -509,6 +880,8 @@ namespace rvs
 		{
 #if _WIN32
 			wglMakeCurrent(context_NO_WRITE.gldc, context_NO_WRITE.glrc);
+#elif WITH_EGL
+			eglMakeCurrent(context_NO_WRITE.disp, EGL_NO_SURFACE, EGL_NO_SURFACE, context_NO_WRITE.ctx);
 #else // linux
 			//glXMakeCurrent(context_NO_WRITE.disp, context_NO_WRITE.win, context_NO_WRITE.ctx);
 			glXMakeContextCurrent(context_NO_WRITE.disp, context_NO_WRITE.win, context_NO_WRITE.win, context_NO_WRITE.ctx);
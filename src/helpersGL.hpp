@@ -53,8 +53,15 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 #include "gl_core_4.5.hpp"
 #include "Config.hpp"
+#include "transform.hpp"
 #include <opencv2/core/mat.hpp>
 
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 // C4201 in glm: nonstandard extension used: nameless struct/union
 #if _MSC_VER >= 1900
 #pragma warning(disable : 4201)
@@ -69,8 +76,12 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #else
 #include <GL/gl.h>
 #include <GL/glu.h>
+#if WITH_EGL
+#include <EGL/egl.h>
+#else
 #include <GL/glx.h>
 #endif
+#endif
 
 #if WITH_RENDERDOC
 #include <renderdoc_app.h>
@@ -112,7 +123,8 @@ namespace rvs
 			GLuint EBO;
 			size_t number_of_elements;
 
-			VAO_VBO_EBO(cv::Size size) 
+			/** Vertices for all pixels, and the triangulation (by default all pixels, see detail::decimate_depth()) */
+			VAO_VBO_EBO(cv::Size size, detail::Triangulation const& triangulation = detail::Triangulation())
 			{
 				cv::Mat1f empty_value = cv::Mat1f::zeros(size);
 				//use fast 4-byte alignment (default anyway) if possible
@@ -129,7 +141,10 @@ namespace rvs
 
 				glBufferData(GL_ARRAY_BUFFER, empty_value.rows*empty_value.cols*empty_value.elemSize(), empty_value.ptr(), GL_STATIC_DRAW);
 
-				generate_picture_EBO(size, number_of_elements);
+				if (triangulation.empty())
+					generate_picture_EBO(size, number_of_elements);
+				else
+					generate_triangulation_EBO(triangulation, number_of_elements);
 
 				GLuint num_components_per_vertex = 1; // depth
 				glVertexAttribPointer(0, num_components_per_vertex, GL_FLOAT, GL_FALSE,
@@ -189,6 +204,180 @@ namespace rvs
 				printf("Real number of elements %i\n", int(elements_number));
 			}
 
+			void generate_triangulation_EBO(const detail::Triangulation &triangulation, size_t &elements_number)
+			{
+				elements_number = 3 * triangulation.size();
+
+				glGenBuffers(1, &EBO);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+				// cv::Vec3i is three contiguous non-negative ints, as GL_UNSIGNED_INT indices
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, elements_number * sizeof(GLuint), triangulation.data(), GL_STATIC_DRAW);
+
+				printf("Real number of elements %i\n", int(elements_number));
+			}
+
+		};
+
+		/**
+		\brief Ring of pixel buffer objects for asynchronous texture uploads and readbacks
+
+		Each buffer is guarded by a fence: the CPU only waits when it maps a buffer of which the GPU has not yet completed the
+		transfer, or when it reuses a buffer that is still in flight. With two or more buffers, the CPU prepares or consumes
+		one transfer while the GPU executes the next.
+		*/
+		class PixelBufferRing
+		{
+		public:
+			/**
+			@param target GL_PIXEL_UNPACK_BUFFER (upload) or GL_PIXEL_PACK_BUFFER (readback)
+			@param count Number of buffers
+			*/
+			PixelBufferRing(GLenum target, int count = 2);
+			PixelBufferRing(PixelBufferRing const&) = delete;
+			PixelBufferRing& operator=(PixelBufferRing const&) = delete;
+			~PixelBufferRing();
+
+			/**
+			\brief Take the next buffer of the ring and bind it to the target
+
+			Waits until the GPU has completed the previous transfer of this buffer.
+			@param size Size in bytes, the buffer is reallocated when it is smaller
+			@return Slot of the buffer
+			*/
+			int acquire(GLsizeiptr size);
+
+			/** Fence the commands issued so far, which complete the transfer of this slot */
+			void fence(int slot);
+
+			/** Wait until the fenced transfer of this slot has completed */
+			void wait(int slot);
+
+			/** Bind the buffer of this slot to the target */
+			void bind(int slot) const;
+
+		private:
+			GLenum m_target;
+			std::vector<GLuint> m_buffers;
+			std::vector<GLsizeiptr> m_sizes;
+			std::vector<GLsync> m_fences;
+			int m_next = 0;
+		};
+
+		/**
+		\brief GPU time of the stages of a frame, measured with GL_TIME_ELAPSED queries
+
+		The queries are double-buffered: the results of a frame are read when the next frame ends, when the GPU has usually
+		completed them. A result that is not available yet is not waited for, but added to the times of a later frame, such that
+		the timing never stalls the pipeline. Time elapsed queries cannot be nested: at most one stage is timed at a time, and a
+		stage can be timed several times per frame (e.g. once per view).
+		*/
+		class GpuTimer
+		{
+		public:
+			/** @param number_of_stages Number of stages, numbered from zero */
+			explicit GpuTimer(int number_of_stages);
+			GpuTimer(GpuTimer const&) = delete;
+			GpuTimer& operator=(GpuTimer const&) = delete;
+			~GpuTimer();
+
+			/** Start timing the GL commands of a stage */
+			void begin(int stage);
+
+			/** Stop timing the stage started by begin() */
+			void end();
+
+			/**
+			\brief End a frame
+
+			@return GPU time in milliseconds of each stage of the previous frame, and of the results of earlier frames that were
+			not available before (empty for the first frame)
+			*/
+			std::vector<double> end_frame();
+
+			/**
+			\brief Wait for the GPU times of the last ended frame and all earlier ones (e.g. at the end of an execution)
+
+			@return GPU time in milliseconds of each stage (empty when no frame is pending)
+			*/
+			std::vector<double> flush();
+
+		private:
+			std::vector<double> collect(int buffer, bool wait);
+
+			int m_number_of_stages;
+			int m_current = 0;
+			bool m_active = false;
+
+			// Stage and query of each timed interval, for the current and the previous frame
+			std::vector<std::pair<int, GLuint>> m_queries[2];
+			std::vector<GLuint> m_free;
+
+			// Stage and query of the timed intervals of earlier frames of which the result was not available when collected
+			std::vector<std::pair<int, GLuint>> m_late;
+		};
+
+		/**
+		\brief GPU resources which only depend on the resolution and format of the input, kept across views and frames
+
+		One per pipeline (see Context). The mesh of the full triangulation is shared by all input views of the same size,
+		and the textures are recycled: new content of the same size and format is streamed through a PixelBufferRing, such that
+		the upload of the next input view overlaps with the drawing of the current one.
+		*/
+		class ResourceCache
+		{
+		public:
+			ResourceCache();
+			ResourceCache(ResourceCache const&) = delete;
+			ResourceCache& operator=(ResourceCache const&) = delete;
+			~ResourceCache();
+
+			/** Mesh of the full triangulation of an input of this size (see VAO_VBO_EBO), created on first use */
+			VAO_VBO_EBO const& mesh(cv::Size size);
+
+			/**
+			\brief Texture with the content of an image
+
+			@param mat Image (see cvMat2glTexture())
+			@param unit Texture unit it is bound to: textures that are in use at the same time need different units
+			@return Texture, owned by the cache
+			*/
+			GLuint texture(const cv::Mat& mat, int unit);
+
+			/**
+			\brief Array texture with the content of images of the same size and format, one layer per image
+
+			@param mats Images (see cvMat2glTexture())
+			@param unit Texture unit it is bound to: textures that are in use at the same time need different units
+			@return Array texture, owned by the cache
+			*/
+			GLuint texture_array(std::vector<cv::Mat> const& mats, int unit);
+
+			/** Vertex array of the full-screen quad of the blending passes (two triangles), created on first use */
+			GLuint quad();
+
+			/**
+			\brief Upload the content of a uniform block, and bind its buffer to the binding point
+
+			The buffer is reallocated on every upload, such that the driver does not wait for the draws that use the previous content.
+			*/
+			void uniform_buffer(GLuint binding, const void* data, GLsizeiptr size);
+
+		private:
+			std::map<std::pair<int, int>, std::unique_ptr<VAO_VBO_EBO>> m_meshes;
+
+			// Textures by width, height, type and unit
+			std::map<std::tuple<int, int, int, int>, GLuint> m_textures;
+
+			// Array textures by width, height, type, unit and number of layers
+			std::map<std::tuple<int, int, int, int, int>, GLuint> m_texture_arrays;
+
+			PixelBufferRing m_uploads;
+
+			GLuint m_quad_vao = 0;
+			GLuint m_quad_vbo = 0;
+
+			// Uniform buffers by binding point
+			std::map<GLuint, GLuint> m_uniform_buffers;
 		};
 
 		// NEVER WRITE ON IT.
@@ -198,6 +387,9 @@ namespace rvs
 			HWND fakewindow = nullptr;
 			HDC gldc = nullptr;
 			HGLRC glrc = nullptr;
+#elif WITH_EGL
+			EGLDisplay disp = EGL_NO_DISPLAY;
+			EGLContext ctx = EGL_NO_CONTEXT;
 #else
 			Display * disp = nullptr;
 			Window win = 0;
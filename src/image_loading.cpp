@@ -60,7 +60,6 @@ namespace rvs
 	namespace
 	{
 		using detail::ColorSpace;
-		using detail::g_color_space;
 
 		void read_raw(std::ifstream& stream, cv::Mat image)
 		{
@@ -192,7 +191,7 @@ namespace rvs
 		return (1u << bit_depth) - 1u;
 	}
 
-	cv::Mat3f read_color(std::string filepath, int frame, Parameters const& parameters)
+	cv::Mat3f read_color(std::string filepath, int frame, Parameters const& parameters, ColorSpace working_color_space)
 	{
 		// Load the image
 		cv::Mat image;
@@ -224,10 +223,10 @@ namespace rvs
 		}
 
 		// Color space conversion
-		if (color_space == ColorSpace::YUV && g_color_space == ColorSpace::RGB) {
+		if (color_space == ColorSpace::YUV && working_color_space == ColorSpace::RGB) {
 			cv::cvtColor(color, color, cv::COLOR_YUV2BGR);
 		}
-		else if (color_space == ColorSpace::RGB && g_color_space == ColorSpace::YUV) {
+		else if (color_space == ColorSpace::RGB && working_color_space == ColorSpace::YUV) {
 			cv::cvtColor(color, color, cv::COLOR_BGR2YUV);
 		}
 
@@ -47,6 +47,7 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #ifndef _IMAGE_LOADING_HPP_
 #define _IMAGE_LOADING_HPP_
 
+#include "Context.hpp"
 #include "Parameters.hpp"
 #include "PolynomialDepth.hpp"
 
@@ -81,9 +82,10 @@ namespace rvs
 	@param filepath Name of the image file (YUV, PNG, etc.)
 	@param frame Number of the frame to read
 	@param parameters Camera and video parameters
+	@param working_color_space Color space to convert the image to
 	@return CV_32FC3 image
 	*/
-	cv::Mat3f read_color(std::string filepath, int frame, Parameters const& parameters);
+	cv::Mat3f read_color(std::string filepath, int frame, Parameters const& parameters, detail::ColorSpace working_color_space);
 
 	/**
 	\brief Read a depth image: a exr depth file or a YUV disparity file.
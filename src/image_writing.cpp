@@ -60,7 +60,6 @@ namespace rvs
 	namespace
 	{
 		using detail::ColorSpace;
-		using detail::g_color_space;
 
 		void write_raw(std::ofstream& stream, cv::Mat image)
 		{
@@ -125,16 +124,16 @@ namespace rvs
 		}
 	}
 
-	void write_color(std::string filepath, cv::Mat3f color, int frame, Parameters const& parameters)
+	void write_color(std::string filepath, cv::Mat3f color, int frame, Parameters const& parameters, ColorSpace working_color_space)
 	{
 		// Color space conversion
 		auto color_space = filepath.substr(filepath.size() - 4, 4) == ".yuv"
 			? ColorSpace::YUV
 			: ColorSpace::RGB;
-		if (g_color_space == ColorSpace::YUV && color_space == ColorSpace::RGB) {
+		if (working_color_space == ColorSpace::YUV && color_space == ColorSpace::RGB) {
 			cv::cvtColor(color, color, cv::COLOR_YUV2BGR);
 		}
-		else if (g_color_space == ColorSpace::RGB && color_space == ColorSpace::YUV) {
+		else if (working_color_space == ColorSpace::RGB && color_space == ColorSpace::YUV) {
 			cv::cvtColor(color, color, cv::COLOR_BGR2YUV);
 		}
 
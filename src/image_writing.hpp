@@ -45,6 +45,7 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #ifndef _IMAGE_WRITING_HPP_
 #define _IMAGE_WRITING_HPP_
 
+#include "Context.hpp"
 #include "Parameters.hpp"
 
 namespace rvs
@@ -61,8 +62,9 @@ namespace rvs
 	@param color Image to write
 	@param frame Frame number (for YUV)
 	@param parameters Camera and video parameters
+	@param working_color_space Color space of the image
 	*/
-	void write_color(std::string filepath, cv::Mat3f color, int frame, Parameters const& parameters);
+	void write_color(std::string filepath, cv::Mat3f color, int frame, Parameters const& parameters, detail::ColorSpace working_color_space);
 
 	/**
 	\brief Write a depth map in RGB or YUV 4:2:0 fileformat.
@@ -45,7 +45,6 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 */
 
 #include "inpainting.hpp"
-#include "Config.hpp"
 
 #include <opencv2/imgproc.hpp>
 #include <opencv2/photo.hpp>
@@ -64,10 +63,10 @@ namespace rvs
 			}
 			return mask;
 		}
-		cv::Mat raffine_mask(cv::Mat mask) {
+		cv::Mat raffine_mask(cv::Mat mask, float rescale) {
 			cv::Mat mask2;
-			erode(mask, mask2, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3 * (int)g_rescale, 3 * (int)g_rescale)), cv::Point(-1, -1), 1);
-			dilate(mask2, mask2, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3 * (int)g_rescale, 3 * (int)g_rescale)), cv::Point(-1, -1), 1);
+			erode(mask, mask2, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3 * (int)rescale, 3 * (int)rescale)), cv::Point(-1, -1), 1);
+			dilate(mask2, mask2, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3 * (int)rescale, 3 * (int)rescale)), cv::Point(-1, -1), 1);
 			return mask2;
 		}
 
@@ -135,7 +134,7 @@ namespace rvs
 					}
 			}
 		}
-		void inpaint_color(const cv::Mat& src, const cv::Mat & mask, cv::Mat& dst) {
+		void inpaint_color(const cv::Mat& src, const cv::Mat & mask, cv::Mat& dst, float rescale) {
 			bool compute_by_interpolation = false;
 			bool compute_by_nearest = true;
 			if (compute_by_interpolation) {
@@ -148,7 +147,7 @@ namespace rvs
 						if (mask.at<bool>(y, x))
 							map.at<cv::Vec4i>(y, x) = cv::Vec4i(map.cols + map.rows, map.cols + map.rows, map.cols + map.rows, map.cols + map.rows);
 					}
-				compute_interpolation(map, (int)(1000.0f*g_rescale));
+				compute_interpolation(map, (int)(1000.0f*rescale));
 				for (int y = 0; y < src.rows; ++y)
 					for (int x = 0; x < src.cols; ++x) {
 						if (mask.at<bool>(y, x)) {
@@ -212,12 +211,12 @@ namespace rvs
 				}
 		}
 
-		cv::Mat inpaint(const cv::Mat& img, const cv::Mat& mask, bool color) {
+		cv::Mat inpaint(const cv::Mat& img, const cv::Mat& mask, bool color, float rescale) {
 
 			cv::Mat inpaint_mask = mask > 0;
 			if (color) {
 				cv::Mat inpainted = img;
-				inpaint_color(img, inpaint_mask, inpainted);
+				inpaint_color(img, inpaint_mask, inpainted, rescale);
 				return inpainted;
 			}
 			else {
@@ -227,10 +226,10 @@ namespace rvs
 		}
 
 		//renvoie un inpainting complet. renvoie une image dans le type demande
-		cv::Mat inpaint_all(const cv::Mat& img, const cv::Mat& prev, int return_type, int cvt_type, int col_cvt_type, int col_cvtback_type, cv::Vec3f empty_color) {
+		cv::Mat inpaint_all(const cv::Mat& img, const cv::Mat& prev, int return_type, int cvt_type, int col_cvt_type, int col_cvtback_type, cv::Vec3f empty_color, float rescale) {
 			cv::Mat img_8;
 			cv::Mat inpaint_mask = prev == 0.f;
-			cv::Mat mask = raffine_mask(inpaint_mask);
+			cv::Mat mask = raffine_mask(inpaint_mask, rescale);
 			if (col_cvt_type > -1)
 				cvtColor(img, img_8, col_cvt_type);
 			else
@@ -61,9 +61,10 @@ namespace rvs
 			@param img Image to inpaint
 			@param mask Area to inpaint
 			@param color True if the image is color, false if it is grayscale
+			@param rescale Precision (oversampling factor) of the image
 			@return inpainted image
 		*/
-		cv::Mat inpaint(const cv::Mat& img, const cv::Mat& mask, bool color);
+		cv::Mat inpaint(const cv::Mat& img, const cv::Mat& mask, bool color, float rescale);
 	}
 }
 
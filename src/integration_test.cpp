@@ -53,9 +53,19 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "yaffut.hpp"
 
 #include "Application.hpp"
+#include "EmbeddedPipeline.hpp"
+#include "image_loading.hpp"
+#include "image_writing.hpp"
+#ifndef _WIN32
+#include "Server.hpp"
+#endif
+#include "SynthesizedView.hpp"
 
 #include <array>
+#include <cstdio>
 #include <fstream>
+#include <string>
+#include <thread>
 
 #include <opencv2/imgproc.hpp>
 
@@ -97,10 +107,11 @@ namespace testing
 
 	// Compare two YUV420 frames and check PSNR is below a threshold	
 	// Two regions are taken because errors are large at the image borders
-	template<typename T> void compareWithReferenceView(
+	// Returns the PSNRs of both regions, to derive the thresholds of a variant from those measured for its baseline
+	template<typename T> cv::Vec2d compareWithReferenceView(
 		std::array<cv::Mat_<T>, 3> const& actual,
 		std::array<cv::Mat_<T>, 3> const& reference,
-		int bits, double threshold0, double threshold1)
+		int bits, double threshold0, double threshold1, bool fixed_thresholds = true)
 	{
 		YAFFUT_CHECK(actual[0].size() == reference[0].size());
 		YAFFUT_CHECK(actual[1].size() == reference[1].size());
@@ -147,17 +158,18 @@ namespace testing
 		YAFFUT_CHECK(psnr[0] > threshold0);
 		YAFFUT_CHECK(psnr[1] > threshold1);
 
-		if ((psnr[0] > threshold0 + 0.1 && threshold0 < 100.) ||
-			(psnr[1] > threshold1 + 0.1 && threshold1 < 100.)) {
+		if (fixed_thresholds && ((psnr[0] > threshold0 + 0.1 && threshold0 < 100.) ||
+			(psnr[1] > threshold1 + 0.1 && threshold1 < 100.))) {
 			std::clog << "WARNING: thresholds can be increased\n";
 		}
+		return cv::Vec2d(psnr[0], psnr[1]);
 	}
 
-	template<typename T> void compareWithReferenceView(
+	template<typename T> cv::Vec2d compareWithReferenceView(
 		char const *filepath_actual,
 		char const *filepath_reference,
 		cv::Size size, int bits,
-		double threshold0, double threshold1)
+		double threshold0, double threshold1, bool fixed_thresholds = true)
 	{
 		std::cout << "Comparing \"" << filepath_actual << "\" " << size << " with \"" << filepath_reference << "\" " << size << std::endl;
 		auto actual = readYUV420<T>(filepath_actual, size);
@@ -167,7 +179,49 @@ namespace testing
 			: sourcePath + "/" + filepath_reference;
         
         auto reference = readYUV420<T>(filepath_reference_mod.c_str(), size);
-		compareWithReferenceView(actual, reference, bits, threshold0, threshold1);
+		return compareWithReferenceView(actual, reference, bits, threshold0, threshold1, fixed_thresholds);
+	}
+
+	// Compare a variant of a baseline configuration, with the PSNRs measured for the baseline in the same run minus a tolerance
+	// as thresholds, such that the thresholds follow the reference data and the platform
+	template<typename T> cv::Vec2d compareWithBaseline(
+		char const *filepath_actual,
+		char const *filepath_reference,
+		cv::Size size, int bits,
+		cv::Vec2d baseline, double tolerance)
+	{
+		std::cout << "Baseline PSNRs: " << baseline[0] << ", " << baseline[1] << " (tolerance " << tolerance << " dB)" << std::endl;
+		return compareWithReferenceView<T>(filepath_actual, filepath_reference, size, bits, baseline[0] - tolerance, baseline[1] - tolerance, false);
+	}
+
+	// Application that sums the raster statistics of the CPU rasterizer over all synthesized input views
+	class RasterStatisticsApplication : public rvs::Application
+	{
+	public:
+		RasterStatisticsApplication(std::string const& filepath, std::string const& sourcepath)
+			: rvs::Application(filepath, sourcepath)
+		{}
+
+		rvs::detail::RasterStatistics statistics;
+
+	protected:
+		void onIntermediateSynthesisResult(int, int, int, int, rvs::SynthesizedView const& synthesizedView) override
+		{
+			statistics.triangles += synthesizedView.getRasterStatistics().triangles;
+			statistics.tests += synthesizedView.getRasterStatistics().tests;
+			statistics.writes += synthesizedView.getRasterStatistics().writes;
+		}
+	};
+
+	// Check that two YUV420 frames are identical, for variants that only change how the same frame is computed
+	template<typename T> void compareBitExact(char const *filepath_actual, char const *filepath_reference, cv::Size size)
+	{
+		std::cout << "Comparing \"" << filepath_actual << "\" " << size << " with \"" << filepath_reference << "\" bit-exact" << std::endl;
+		auto actual = readYUV420<T>(filepath_actual, size);
+		auto reference = readYUV420<T>(filepath_reference, size);
+		for (int i_plane = 0; i_plane != 3; ++i_plane) {
+			YAFFUT_EQUAL(0, cv::countNonZero(actual[i_plane] != reference[i_plane]));
+		}
 	}
 }
 
@@ -178,7 +232,6 @@ namespace rvs
 
 FUNC(ULB_Unicorn_Example)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/example_config_file.json", sourcePath);
 	p.execute();
 	// No reference
@@ -186,7 +239,6 @@ FUNC(ULB_Unicorn_Example)
 
 FUNC(ULB_Unicorn_Triangles_Simple)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/Unicorn_Triangles_Simple.json", sourcePath);
 	p.execute();
 
@@ -197,9 +249,8 @@ FUNC(ULB_Unicorn_Triangles_Simple)
 		cv::Size(1920, 1080), 8, 21.08, 26.12); // VC15 + OpenCV 3.4.1: 21.1318, 26.1742
 
 #if WITH_OPENGL
-	rvs::g_with_opengl = true;
 	rvs::opengl::context_init();
-	rvs::Application pgl("./config_files/_integration_tests/Unicorn_Triangles_Simple_OpenGL.json");
+	rvs::Application pgl("./config_files/_integration_tests/Unicorn_Triangles_Simple_OpenGL.json", sourcePath, true);
 	pgl.execute();
 
 	// OpenGL vs reference
@@ -216,9 +267,51 @@ FUNC(ULB_Unicorn_Triangles_Simple)
 #endif
 }
 
+FUNC(ULB_Unicorn_Triangles_MeshDecimation)
+{
+	// The input views of MeshDecimation need to be perspective (see Test_SynthesizedView_prepare)
+	rvs::Application full("./config_files/_integration_tests/Unicorn_Triangles_Simple.json", sourcePath);
+	full.execute();
+	rvs::Application p("./config_files/_integration_tests/Unicorn_Triangles_MeshDecimation.json", sourcePath);
+	p.execute();
+
+	// Full triangulation vs reference, with the thresholds of ULB_Unicorn_Triangles_Simple
+	auto baseline = testing::compareWithReferenceView<std::uint8_t>(
+		"030003250438_from_030003070370_030003430506_Triangles_Simple.yuv",
+		"Plane_B'/Plane_B'_Texture/Kinect_z0300y0325x0438.yuv",
+		cv::Size(1920, 1080), 8, 21.08, 26.12);
+
+	// No OpenGL vs reference: only blocks that are planar within 1% of their depth are merged, within 0.3 dB of the full
+	// triangulation
+	testing::compareWithBaseline<std::uint8_t>(
+		"030003250438_from_030003070370_030003430506_Triangles_MeshDecimation.yuv",
+		"Plane_B'/Plane_B'_Texture/Kinect_z0300y0325x0438.yuv",
+		cv::Size(1920, 1080), 8, baseline, 0.3);
+}
+
+FUNC(ULB_Unicorn_Triangles_OcclusionOrder)
+{
+	// The occlusion-compatible order only applies to perspective input views
+	testing::RasterStatisticsApplication raster("./config_files/_integration_tests/Unicorn_Triangles_Simple.json", sourcePath);
+	raster.execute();
+	testing::RasterStatisticsApplication p("./config_files/_integration_tests/Unicorn_Triangles_OcclusionOrder.json", sourcePath);
+	p.execute();
+
+	// The same triangles cover the same pixels, but nearest first most of the farther ones fail the depth test
+	YAFFUT_CHECK(raster.statistics.triangles > 0u);
+	YAFFUT_EQUAL(raster.statistics.triangles, p.statistics.triangles);
+	YAFFUT_EQUAL(raster.statistics.tests, p.statistics.tests);
+	YAFFUT_CHECK(p.statistics.writes < raster.statistics.writes);
+
+	// No OpenGL vs reference, with the thresholds of ULB_Unicorn_Triangles_Simple
+	testing::compareWithReferenceView<std::uint8_t>(
+		"030003250438_from_030003070370_030003430506_Triangles_OcclusionOrder.yuv",
+		"Plane_B'/Plane_B'_Texture/Kinect_z0300y0325x0438.yuv",
+		cv::Size(1920, 1080), 8, 21.08, 26.12, false);
+}
+
 FUNC(ULB_Unicorn_Triangles_MultiSpectral)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/Unicorn_Triangles_MultiSpectral.json", sourcePath);
 	p.execute();
 
@@ -229,9 +322,20 @@ FUNC(ULB_Unicorn_Triangles_MultiSpectral)
 		cv::Size(1920, 1080), 8, 21.06, 25.89); // VC15 + OpenCV 3.4.1: 21.1138, 25.9494
 }
 
+FUNC(ULB_Unicorn_Triangles_Laplacian)
+{
+	rvs::Application p("./config_files/_integration_tests/Unicorn_Triangles_Laplacian.json", sourcePath);
+	p.execute();
+
+	// No OpenGL vs reference
+	testing::compareWithReferenceView<std::uint8_t>(
+		"030003250438_from_030003070370_030003430506_Triangles_Laplacian.yuv",
+		"Plane_B'/Plane_B'_Texture/Kinect_z0300y0325x0438.yuv",
+		cv::Size(1920, 1080), 8, 21.06, 25.89);
+}
+
 FUNC(ULB_Unicorn_Same_View)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/Unicorn_Same_View.json", sourcePath);
 	p.execute();
 
@@ -244,7 +348,6 @@ FUNC(ULB_Unicorn_Same_View)
 
 FUNC(ClassroomVideo_v0_to_v0)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/ClassroomVideo-v0_to_v0.json", sourcePath);
 	p.execute();
 
@@ -263,7 +366,6 @@ FUNC(ClassroomVideo_v0_to_v0)
 
 FUNC(ClassroomVideo_v7v8_to_v0)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/ClassroomVideo-v7v8_to_v0.json", sourcePath);
 	p.execute();
 
@@ -274,9 +376,8 @@ FUNC(ClassroomVideo_v7v8_to_v0)
 		cv::Size(4096, 2048), 10, 35.37, 36.27); // VC15 + OpenCV 3.4.1: 35.3846, 36.2868
 
 #if WITH_OPENGL
-	rvs::g_with_opengl = true;
 	rvs::opengl::context_init();
-	rvs::Application pGL("./config_files/_integration_tests/ClassroomVideo-v7v8_to_v0_OpenGL.json");
+	rvs::Application pGL("./config_files/_integration_tests/ClassroomVideo-v7v8_to_v0_OpenGL.json", sourcePath, true);
 	pGL.execute();
 
 	// OpenGL vs reference
@@ -295,7 +396,6 @@ FUNC(ClassroomVideo_v7v8_to_v0)
 
 FUNC(ClassroomVideo_v7v8_to_v0_270deg)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/ClassroomVideo-v7v8_to_v0_270deg.json", sourcePath);
 	p.execute();
 
@@ -316,7 +416,6 @@ FUNC(ClassroomVideo_v7v8_to_v0_270deg)
 
 FUNC(TechnicolorHijack_v1v4_to_v9)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/TechnicolorHijack-v1v4_to_v9.json", sourcePath);
 	p.execute();
 
@@ -333,9 +432,8 @@ FUNC(TechnicolorHijack_v1v4_to_v9)
 		cv::Size(4096, 4096), 10, 23.12, 39.03); // VC15 + OpenCV 3.4.1: 23.1774, 39.0874
 
 #if WITH_OPENGL
-	rvs::g_with_opengl = true;
 	rvs::opengl::context_init();
-	rvs::Application pGL("./config_files/_integration_tests/TechnicolorHijack-v1v4_to_v9_OpenGL.json");
+	rvs::Application pGL("./config_files/_integration_tests/TechnicolorHijack-v1v4_to_v9_OpenGL.json", sourcePath, true);
 	pGL.execute();
 
 	// OpenGL vs. reference
@@ -354,7 +452,6 @@ FUNC(TechnicolorHijack_v1v4_to_v9)
 
 FUNC(TechnicolorHijack_BlendByMax)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/TechnicolorHijack-BlendByMax.json", sourcePath);
 	p.execute();
 
@@ -365,9 +462,179 @@ FUNC(TechnicolorHijack_BlendByMax)
 		cv::Size(4096, 4096), 10, 42.86, 35.00); // VC15 + OpenCV 3.4.1:  42.8731, 35.0181
 }
 
+FUNC(TechnicolorHijack_BackwardWarp)
+{
+	rvs::Application triangles("./config_files/_integration_tests/TechnicolorHijack-v1v4_to_v9.json", sourcePath);
+	triangles.execute();
+	rvs::Application p("./config_files/_integration_tests/TechnicolorHijack-BackwardWarp.json", sourcePath);
+	p.execute();
+
+	// Triangles vs reference, with the thresholds of TechnicolorHijack_v1v4_to_v9
+	auto baseline = testing::compareWithReferenceView<std::uint16_t>(
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b.yuv",
+		"TechnicolorHijack/v9_4096_4096_420_10b.yuv",
+		cv::Size(4096, 4096), 10, 43.50, 35.71);
+
+	// No OpenGL vs reference: the same geometry, with the color resampled bilinearly in the input view instead of
+	// interpolated over the warped triangles, within 0.5 dB of Triangles
+	testing::compareWithBaseline<std::uint16_t>(
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_BackwardWarp.yuv",
+		"TechnicolorHijack/v9_4096_4096_420_10b.yuv",
+		cv::Size(4096, 4096), 10, baseline, 0.5);
+}
+
+FUNC(TechnicolorHijack_Splat)
+{
+	rvs::Application p("./config_files/_integration_tests/TechnicolorHijack-Splat.json", sourcePath);
+	p.execute();
+
+	// No OpenGL vs reference: a preview, so the thresholds are well below those of TechnicolorHijack_v1v4_to_v9
+	testing::compareWithReferenceView<std::uint16_t>(
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_Splat.yuv",
+		"TechnicolorHijack/v9_4096_4096_420_10b.yuv",
+		cv::Size(4096, 4096), 10, 38.00, 32.00);
+}
+
+FUNC(TechnicolorHijack_TiledOversampling)
+{
+	rvs::Application oversampled("./config_files/_integration_tests/TechnicolorHijack-Precision2.json", sourcePath);
+	oversampled.execute();
+	rvs::Application p("./config_files/_integration_tests/TechnicolorHijack-TiledOversampling.json", sourcePath);
+	p.execute();
+
+	// Precision 2 vs reference, at least the thresholds of TechnicolorHijack_v1v4_to_v9 (Precision 1)
+	auto baseline = testing::compareWithReferenceView<std::uint16_t>(
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_Precision2.yuv",
+		"TechnicolorHijack/v9_4096_4096_420_10b.yuv",
+		cv::Size(4096, 4096), 10, 43.50, 35.71, false);
+
+	// No OpenGL vs reference: the same samples, resolved before instead of after blending and inpainting, within 0.2 dB of
+	// Precision 2
+	testing::compareWithBaseline<std::uint16_t>(
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_TiledOversampling.yuv",
+		"TechnicolorHijack/v9_4096_4096_420_10b.yuv",
+		cv::Size(4096, 4096), 10, baseline, 0.2);
+}
+
+FUNC(TechnicolorHijack_Parallel)
+{
+	rvs::Application sequential("./config_files/_integration_tests/TechnicolorHijack-Sequential.json", sourcePath);
+	sequential.execute();
+	rvs::Application p("./config_files/_integration_tests/TechnicolorHijack-Parallel.json", sourcePath);
+	p.execute();
+
+	// Same thresholds as TechnicolorHijack_v1v4_to_v9: the virtual views are computed independently
+	testing::compareWithReferenceView<std::uint16_t>(
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_Parallel.yuv",
+		"TechnicolorHijack/v9_4096_4096_420_10b.yuv",
+		cv::Size(4096, 4096), 10, 43.50, 35.71);
+
+	// Parallel vs sequential: both virtual views share the resident input views, and are identical
+	testing::compareBitExact<std::uint16_t>(
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_Parallel.yuv",
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_Sequential.yuv",
+		cv::Size(4096, 4096));
+	testing::compareBitExact<std::uint16_t>(
+		"TechnicolorHijack_v1vs_from_v1v4_4096_4096_420_10b_Parallel.yuv",
+		"TechnicolorHijack_v1vs_from_v1v4_4096_4096_420_10b_Sequential.yuv",
+		cv::Size(4096, 4096));
+}
+
+FUNC(TechnicolorHijack_Embedded)
+{
+	// Same views as TechnicolorHijack_v1v4_to_v9, but only the camera parameters come from the configuration file
+	auto file = rvs::Config::loadFromFile("./config_files/_integration_tests/TechnicolorHijack-v1v4_to_v9.json");
+	auto config = rvs::Config::create(file.InputCameraNames, file.params_real, file.VirtualCameraNames, file.params_virtual);
+
+	// Caller-owned input buffers
+	std::vector<cv::Mat3f> colors;
+	std::vector<cv::Mat1f> depths;
+	for (auto i = 0u; i != config.InputCameraNames.size(); ++i) {
+		colors.push_back(rvs::read_color(file.texture_names[i], 0, config.params_real[i], config.color_space));
+		depths.push_back(rvs::read_depth(file.depth_names[i], 0, config.params_real[i]));
+	}
+
+	rvs::EmbeddedPipeline p(config);
+	p.setInput([&](int, int inputView) {
+		rvs::InputBuffers buffers;
+		buffers.color = colors[inputView].ptr<float>();
+		buffers.color_step = colors[inputView].step;
+		buffers.depth = depths[inputView].ptr<float>();
+		buffers.depth_step = depths[inputView].step;
+		return buffers;
+	});
+	auto called = 0;
+	p.onColor([&](int virtualFrame, int virtualView, cv::Mat3f const& color) {
+		rvs::write_color("TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_Embedded.yuv", color, virtualFrame, config.params_virtual[virtualView], config.color_space);
+		++called;
+	});
+	p.execute();
+	YAFFUT_EQUAL(1, called);
+
+	// Same thresholds as TechnicolorHijack_v1v4_to_v9
+	testing::compareWithReferenceView<std::uint16_t>(
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_Embedded.yuv",
+		"TechnicolorHijack/v9_4096_4096_420_10b.yuv",
+		cv::Size(4096, 4096), 10, 43.50, 35.71);
+}
+
+#ifndef _WIN32
+FUNC(TechnicolorHijack_Server)
+{
+	auto const filepath = "./config_files/_integration_tests/TechnicolorHijack-v1v4_to_v9.json";
+	auto const socketpath = "TechnicolorHijack_Server.sock";
+	auto config = rvs::Config::loadFromFile(filepath);
+
+	rvs::Server server(filepath, socketpath);
+	std::thread thread([&server]() { server.serve(); });
+
+	// Request the pose of v9 twice in one request: the second frame reuses the resident input views
+	rvs::Pose pose{ cv::Vec3f::all(0.f), config.params_virtual[0].getRotation() };
+	cv::Mat3f colors[2];
+	{
+		rvs::Client client(socketpath);
+		client.request({ pose, pose });
+		for (auto i = 0; i != 2; ++i) {
+			rvs::server::FrameHeader header;
+			colors[i] = client.receive(header);
+			YAFFUT_EQUAL(static_cast<unsigned>(i), header.pose);
+			YAFFUT_EQUAL(0u, header.virtual_view);
+			YAFFUT_EQUAL(1u, header.number_of_virtual_views);
+		}
+		client.shutdown();
+	}
+	thread.join();
+	YAFFUT_EQUAL(2u, server.getLatencies().count());
+	YAFFUT_EQUAL(0., cv::norm(colors[0], colors[1], cv::NORM_INF));
+
+	// Same thresholds as TechnicolorHijack_v1v4_to_v9
+	rvs::write_color("TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_Server.yuv", colors[0], 0, config.params_virtual[0], config.color_space);
+	testing::compareWithReferenceView<std::uint16_t>(
+		"TechnicolorHijack_v9vs_from_v1v4_4096_4096_420_10b_Server.yuv",
+		"TechnicolorHijack/v9_4096_4096_420_10b.yuv",
+		cv::Size(4096, 4096), 10, 43.50, 35.71);
+}
+
+FUNC(Server_socket_path_is_a_file)
+{
+	// A file that is not a socket is never removed to listen on its path
+	auto const socketpath = "Server_socket_path_is_a_file.sock";
+	std::ofstream(socketpath) << "not a socket";
+	auto thrown = false;
+	try {
+		rvs::Server server("./config_files/_integration_tests/TechnicolorHijack-v1v4_to_v9.json", socketpath);
+	}
+	catch (std::runtime_error&) {
+		thrown = true;
+	}
+	YAFFUT_CHECK(thrown);
+	YAFFUT_CHECK(std::ifstream(socketpath).good());
+	std::remove(socketpath);
+}
+#endif
+
 FUNC(TechnicolorMuseum_v0v2v13v17v19_to_v1)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/TechnicolorMuseum-v0v2v13v17v19_to_v1.json", sourcePath);
 	p.execute();
 
@@ -378,9 +645,8 @@ FUNC(TechnicolorMuseum_v0v2v13v17v19_to_v1)
 		cv::Size(2048, 2048), 10, 31.88, 38.42); // VC15 + OpenCV 3.4.1:   31.8979, 38.4389
 
 #if WITH_OPENGL
-	rvs::g_with_opengl = true;
 	rvs::opengl::context_init();
-	rvs::Application pGL("./config_files/_integration_tests/TechnicolorMuseum-v0v2v13v17v19_to_v1_OpenGL.json");
+	rvs::Application pGL("./config_files/_integration_tests/TechnicolorMuseum-v0v2v13v17v19_to_v1_OpenGL.json", sourcePath, true);
 	pGL.execute();
 
 	// OpenGL vs reference
@@ -397,9 +663,30 @@ FUNC(TechnicolorMuseum_v0v2v13v17v19_to_v1)
 #endif
 }
 
+#if WITH_OPENGL
+FUNC(TechnicolorMuseum_v0v2v13v17v19_to_v1_Batched)
+{
+	rvs::opengl::context_init();
+	for (auto blending : { "", "_Mean" }) {
+		auto config = std::string("./config_files/_integration_tests/TechnicolorMuseum-v0v2v13v17v19_to_v1_OpenGL") + blending;
+		rvs::Application sequential(config + ".json", sourcePath, true);
+		sequential.execute();
+		rvs::Application batched(config + "_Batched.json", sourcePath, true);
+		batched.execute();
+
+		// Batched vs sequential, with BlendingFactor 5 and 0.5: the same weights and the same order of the views, only
+		// the floating-point rounding of the accumulation differs, hence at least 50 dB
+		auto output = std::string("TechnicolorMuseum_v1vs_from_v0v2v13v17v19_2048_2048_420_10b_OpenGL") + blending;
+		testing::compareWithReferenceView<std::uint16_t>(
+			(output + "_Batched.yuv").c_str(),
+			(output + ".yuv").c_str(),
+			cv::Size(2048, 2048), 10, 50.00, 50.00, false);
+	}
+}
+#endif
+
 FUNC(TechnicolorMuseum_v0_to_v0)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/TechnicolorMuseum-v0_to_v0.json", sourcePath);
 	p.execute();
 
@@ -412,7 +699,6 @@ FUNC(TechnicolorMuseum_v0_to_v0)
 
 FUNC(TechnicolorMuseum_v5_to_v5)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/TechnicolorMuseum-v5_to_v5.json", sourcePath);
 	p.execute();
 
@@ -425,7 +711,6 @@ FUNC(TechnicolorMuseum_v5_to_v5)
 
 FUNC(TechnicolorMuseum_v5_to_v6)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/TechnicolorMuseum-v5_to_v6.json", sourcePath);
 	p.execute();
 
@@ -436,9 +721,39 @@ FUNC(TechnicolorMuseum_v5_to_v6)
 		cv::Size(2048, 2048), 10, 21.83, 26.50); // VC15 + OpenCV 3.4.1:  21.8415, 26.5167
 }
 
+#if WITH_OPENGL
+FUNC(TechnicolorMuseum_v5_to_v6_Inpainting)
+{
+	rvs::Application p("./config_files/_integration_tests/TechnicolorMuseum-v5_to_v6.json", sourcePath);
+	p.execute();
+	rvs::opengl::context_init();
+	rvs::Application pGL("./config_files/_integration_tests/TechnicolorMuseum-v5_to_v6_OpenGL.json", sourcePath, true);
+	pGL.execute();
+
+	// No OpenGL vs reference, with the thresholds of TechnicolorMuseum_v5_to_v6
+	auto baseline = testing::compareWithReferenceView<std::uint16_t>(
+		"TechnicolorMuseum_v6vs_from_v5_2048_2048_420_10b.yuv",
+		"TechnicolorMuseum/v6_2048_2048_420_10b.yuv",
+		cv::Size(2048, 2048), 10, 21.83, 26.50);
+
+	// OpenGL vs reference: one input view leaves large holes, inpainted on the GPU by jump flooding instead of on the CPU.
+	// The rasterization of the other OpenGL tests already costs up to 1.7 dB, hence within 2 dB
+	testing::compareWithBaseline<std::uint16_t>(
+		"TechnicolorMuseum_v6vs_from_v5_2048_2048_420_10b_OpenGL.yuv",
+		"TechnicolorMuseum/v6_2048_2048_420_10b.yuv",
+		cv::Size(2048, 2048), 10, baseline, 2.0);
+
+	// No OpenGL vs OpenGL: both fill the holes with the nearest known pixel, so they are closer to each other than to the
+	// reference
+	testing::compareWithReferenceView<std::uint16_t>(
+		"TechnicolorMuseum_v6vs_from_v5_2048_2048_420_10b.yuv",
+		"TechnicolorMuseum_v6vs_from_v5_2048_2048_420_10b_OpenGL.yuv",
+		cv::Size(2048, 2048), 10, baseline[0], baseline[1], false);
+}
+#endif
+
 FUNC(TechnicolorMuseum_PoseTrace)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/TechnicolorMuseum-PoseTrace.json", sourcePath);
 	p.execute();
 
@@ -451,7 +766,6 @@ FUNC(TechnicolorMuseum_PoseTrace)
 
 FUNC(TechnicolorMuseum_translucency)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/TechnicolorMuseum-translucency.json", sourcePath);
 	p.execute();
 
@@ -468,7 +782,6 @@ FUNC(TechnicolorMuseum_translucency)
 
 FUNC(TechnicolorMuseum_translucency_inverse)
 {
-	rvs::g_with_opengl = false;
 	rvs::Application p("./config_files/_integration_tests/TechnicolorMuseum-translucency-inverse.json", sourcePath);
 	p.execute();
 
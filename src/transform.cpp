@@ -50,58 +50,92 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 #include <iostream>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
 
 namespace rvs
 {
 	namespace detail
 	{
-		extern float g_rescale; // Config.hpp
-
 		namespace
 		{
-			float valid_tri(cv::Vec2f A, cv::Vec2f B, cv::Vec2f C) {
+			// Quality of a warped triangle or splat: decreases with the stretch (in output pixels)
+			float stretch_quality(float stretch, float rescale) {
+				stretch /= rescale;
+
+				float quality = 10000.f - 1000.f * stretch;
+				quality = std::max(1.f, quality); // always > 0
+				quality = std::min(10000.f, quality);
+
+				return quality;
+			}
+
+			float valid_tri(cv::Vec2f A, cv::Vec2f B, cv::Vec2f C, float rescale) {
 				double dab = cv::norm(A, B);
 				double dac = cv::norm(A, C);
 				double dbc = cv::norm(B, C);
 
 				float stretch = static_cast<float>(std::max(dbc, std::max(dab, dac)));
-				stretch /= g_rescale;
+				return stretch_quality(stretch, rescale);
+			}
 
-				float quality = 10000.f - 1000.f * stretch;
-				quality = std::max(1.f, quality); // always > 0
-				quality = std::min(10000.f, quality);
+			// Bilinear interpolation of the color at a position inside the image (pixel centers at integer positions)
+			cv::Vec3f sample_color(const cv::Mat & img, cv::Vec2f p) {
+				auto x0 = std::min(static_cast<int>(p[0]), img.cols - 1);
+				auto y0 = std::min(static_cast<int>(p[1]), img.rows - 1);
+				auto x1 = std::min(x0 + 1, img.cols - 1);
+				auto y1 = std::min(y0 + 1, img.rows - 1);
+				auto fx = p[0] - x0;
+				auto fy = p[1] - y0;
 
-				return quality;
+				return (1.f - fy) * ((1.f - fx) * img.at<cv::Vec3f>(y0, x0) + fx * img.at<cv::Vec3f>(y0, x1))
+					+ fy * ((1.f - fx) * img.at<cv::Vec3f>(y1, x0) + fx * img.at<cv::Vec3f>(y1, x1));
 			}
 
-			void colorize_triangle(const cv::Mat & img, const cv::Mat & depth, const cv::Mat& depth_prologation_mask, const cv::Mat & new_pos, cv::Mat& res, cv::Mat& new_depth, cv::Mat& new_depth_prologation_mask, cv::Mat& triangle_shape, cv::Point a, cv::Point b, cv::Point c) {
-				cv::Vec2f A = new_pos.at<cv::Vec2f>(a);
-				cv::Vec2f B = new_pos.at<cv::Vec2f>(b);
-				cv::Vec2f C = new_pos.at<cv::Vec2f>(c);
+			// Rasterize one triangle; without color only the depth and quality are updated (img and res are not used)
+			// The output buffers may be a tile of the output: the origin is the position of their top-left pixel
+			// The scale is the length of the shortest edge in input pixels: 1 for the triangles of two neighbouring pixels,
+			// larger for merged triangles (see decimate_depth), of which the color is sampled from the input image
+			template<bool with_color>
+			void colorize_triangle(const cv::Mat & img, const cv::Mat & depth, const cv::Mat& depth_prologation_mask, const cv::Mat & new_pos, cv::Mat& res, cv::Mat& new_depth, cv::Mat& new_depth_prologation_mask, cv::Mat& triangle_shape, cv::Point a, cv::Point b, cv::Point c, float rescale, RasterStatistics& statistics, float scale = 1.f, cv::Vec2f origin = cv::Vec2f()) {
+				cv::Vec2f A = new_pos.at<cv::Vec2f>(a) - origin;
+				cv::Vec2f B = new_pos.at<cv::Vec2f>(b) - origin;
+				cv::Vec2f C = new_pos.at<cv::Vec2f>(c) - origin;
 
 				float den = (B[1] - C[1]) * (A[0] - C[0]) + (C[0] - B[0]) * (A[1] - C[1]);
 				if (den <= 0.f)
 					return;
 
-				float triangle_validity = valid_tri(A, B, C);
+				float triangle_validity = valid_tri(A, B, C, rescale * scale);
 				if (triangle_validity == 0.f)
 					return;
 
 				auto Xmin = std::max(0, static_cast<int>(std::floor(std::min(std::min(A[0], B[0]), C[0]))));
 				auto Ymin = std::max(0, static_cast<int>(std::floor(std::min(std::min(A[1], B[1]), C[1]))));
-				auto Xmax = std::min(res.cols - 1, static_cast<int>(std::ceil(std::max(std::max(A[0], B[0]), C[0]))));
-				auto Ymax = std::min(res.rows - 1, static_cast<int>(std::ceil(std::max(std::max(A[1], B[1]), C[1]))));
+				auto Xmax = std::min(new_depth.cols - 1, static_cast<int>(std::ceil(std::max(std::max(A[0], B[0]), C[0]))));
+				auto Ymax = std::min(new_depth.rows - 1, static_cast<int>(std::ceil(std::max(std::max(A[1], B[1]), C[1]))));
 
 				if (Ymin > Ymax || Xmin > Xmax)
 					return;
 
-				cv::Vec3f colA = img.at<cv::Vec3f>(a);
-				cv::Vec3f colB = img.at<cv::Vec3f>(b);
-				cv::Vec3f colC = img.at<cv::Vec3f>(c);
+				auto const sampled = scale > 1.f;
+				cv::Vec3f colA, colB, colC;
+				if (with_color && !sampled) {
+					colA = img.at<cv::Vec3f>(a);
+					colB = img.at<cv::Vec3f>(b);
+					colC = img.at<cv::Vec3f>(c);
+				}
 				float dA = depth.at<float>(a);
 				float dB = depth.at<float>(b);
 				float dC = depth.at<float>(c);
 
+				std::size_t tests = 0;
+				std::size_t writes = 0;
 				for (int y = Ymin; y <= Ymax; ++y)
 					for (int x = Xmin; x <= Xmax; ++x)
 					{
@@ -113,7 +147,7 @@ namespace rvs
 						float const eps = 1e-6f;
 						if (lambda_1 >= -eps && lambda_2 >= -eps && lambda_3 >= -eps)
 						{
-							cv::Vec3f col = colA * lambda_1 + colB * lambda_2 + colC * lambda_3;
+							++tests;
 							float d = dA * lambda_1 + dB * lambda_2 + dC * lambda_3;
 
 							auto& new_d = new_depth.at<float>(y, x);
@@ -128,55 +162,591 @@ namespace rvs
 							//if the pixel comes from original depth map and is in foreground
 							if ((is_valid || new_prol) && !prol)
 							{
+								++writes;
 								new_d = d;
 								new_prol = false;
 								shape = triangle_validity;
-								res.at<cv::Vec3f>(y, x) = col;
+								if (with_color)
+									res.at<cv::Vec3f>(y, x) = sampled
+										? sample_color(img, cv::Vec2f(cv::Point2f(a) * lambda_1 + cv::Point2f(b) * lambda_2 + cv::Point2f(c) * lambda_3))
+										: colA * lambda_1 + colB * lambda_2 + colC * lambda_3;
 							}
 							//if the pixel comes from inpainted depth map and is in foreground and there is no pixel from the original depth map
 							else if (is_valid && new_prol && prol)
 							{
+								++writes;
 								new_d = d;
 								shape = triangle_validity;
-								res.at<cv::Vec3f>(y, x) = col;
+								if (with_color)
+									res.at<cv::Vec3f>(y, x) = sampled
+										? sample_color(img, cv::Vec2f(cv::Point2f(a) * lambda_1 + cv::Point2f(b) * lambda_2 + cv::Point2f(c) * lambda_3))
+										: colA * lambda_1 + colB * lambda_2 + colC * lambda_3;
+							}
+						}
+					}
+
+				++statistics.triangles;
+				statistics.tests += tests;
+				statistics.writes += writes;
+			}
+
+			// Cells 0 .. n - 1 as two runs on either side of the epipole coordinate e, each away from it or toward it
+			std::array<std::vector<int>, 2> traversal_runs(int n, float e, bool away)
+			{
+				if (std::isnan(e)) {
+					e = 0.f;
+				}
+				auto s = static_cast<int>(std::floor(std::min(std::max(e, 0.f), static_cast<float>(n))));
+
+				std::array<std::vector<int>, 2> runs;
+				for (int k = s - 1; k >= 0; --k) {
+					runs[0].push_back(k);
+				}
+				for (int k = s; k < n; ++k) {
+					runs[1].push_back(k);
+				}
+				if (!away) {
+					std::reverse(runs[0].begin(), runs[0].end());
+					std::reverse(runs[1].begin(), runs[1].end());
+				}
+				return runs;
+			}
+
+			// Input of the rasterization of triangles
+			struct TriangleInput
+			{
+				cv::Mat3f color;
+				cv::Mat1f depth;
+				cv::Mat1b depth_mask;
+				cv::Mat2f positions;
+				Triangulation const& triangulation;
+				bool horizontalWrap;
+				float rescale;
+			};
+
+			// Output of the rasterization of triangles: buffers with the position of their top-left pixel in output pixels
+			struct TriangleOutput
+			{
+				cv::Mat3f color;
+				cv::Mat1f depth;
+				cv::Mat1f shape;
+				cv::Mat1b prologation;
+				cv::Vec2f origin;
+				RasterStatistics statistics;
+			};
+
+			template<bool with_color>
+			void draw_triangle(TriangleInput const& in, TriangleOutput& out, cv::Point a, cv::Point b, cv::Point c, float scale = 1.f)
+			{
+				colorize_triangle<with_color>(in.color, in.depth, in.depth_mask, in.positions, out.color, out.depth, out.prologation, out.shape,
+					a, b, c, in.rescale, out.statistics, scale, out.origin);
+			}
+
+			// Rasterize one item. Without triangulation: the two triangles between pixels (i, j) and (i + 1, j + 1) for item = i * w + j.
+			// With triangulation: the triangle of that index, or for a negative item the triangles stitching the borders of row -1 - item
+			template<bool with_color>
+			void draw_item(TriangleInput const& in, TriangleOutput& out, int item)
+			{
+				auto const& input_depth = in.depth;
+				auto const& input_positions = in.positions;
+				int w = input_depth.cols;
+
+				if (!in.triangulation.empty() && item >= 0) {
+					auto is_valid = [&](cv::Point p) { return input_depth(p) > 0.f && input_positions(p)[0] > 0.f; };
+					auto const& triangle = in.triangulation[item];
+					cv::Point a(triangle[0] % w, triangle[0] / w);
+					cv::Point b(triangle[1] % w, triangle[1] / w);
+					cv::Point c(triangle[2] % w, triangle[2] / w);
+					if (is_valid(a) && is_valid(b) && is_valid(c)) {
+						auto scale = static_cast<float>(std::min(std::min(cv::norm(a - b), cv::norm(a - c)), cv::norm(b - c)));
+						draw_triangle<with_color>(in, out, a, b, c, scale);
+					}
+					return;
+				}
+
+				int i = in.triangulation.empty() ? item / w : -1 - item;
+				int j = in.triangulation.empty() ? item % w : 0;
+				if (input_depth(i, j + 1) > 0.f && input_depth(i + 1, j) > 0.f && /*why?*/ input_positions(i, j + 1)[0] > 0.f && /*why?*/ input_positions(i + 1, j)[0] > 0.f) {
+					if (in.triangulation.empty()) {
+						if (input_depth(i, j) > 0.f && /*why?*/ input_positions(i, j)[0] > 0.f)
+							draw_triangle<with_color>(in, out, cv::Point(j, i), cv::Point(j + 1, i), cv::Point(j, i + 1));
+						if (input_depth(i + 1, j + 1) > 0.f && input_positions(i + 1, j + 1)[0] > 0.f)
+							draw_triangle<with_color>(in, out, cv::Point(j + 1, i + 1), cv::Point(j, i + 1), cv::Point(j + 1, i));
+					}
+
+					// stitch left and right borders with triangles (e.g. for equirectangular projection)
+					if (in.horizontalWrap && j == 0) {
+						draw_triangle<with_color>(in, out, cv::Point(w - 1, i), cv::Point(0, i), cv::Point(w - 1, i + 1));
+						draw_triangle<with_color>(in, out, cv::Point(0, i + 1), cv::Point(w - 1, i + 1), cv::Point(0, i));
+					}
+				}
+			}
+
+			// Bounding box of the warped vertices of an item (see draw_item); false when it cannot draw a triangle
+			bool item_bounds(TriangleInput const& in, int item, cv::Vec2f& lo, cv::Vec2f& hi)
+			{
+				int w = in.depth.cols;
+				cv::Point vertices[6];
+				int n = 0;
+				if (!in.triangulation.empty() && item >= 0) {
+					for (int k = 0; k != 3; ++k) {
+						vertices[n++] = cv::Point(in.triangulation[item][k] % w, in.triangulation[item][k] / w);
+					}
+				}
+				else {
+					int i = in.triangulation.empty() ? item / w : -1 - item;
+					int j = in.triangulation.empty() ? item % w : 0;
+					vertices[n++] = cv::Point(j, i);
+					vertices[n++] = cv::Point(j + 1, i);
+					vertices[n++] = cv::Point(j, i + 1);
+					vertices[n++] = cv::Point(j + 1, i + 1);
+					if (in.horizontalWrap && j == 0) {
+						vertices[n++] = cv::Point(w - 1, i);
+						vertices[n++] = cv::Point(w - 1, i + 1);
+					}
+				}
+
+				auto valid = 0;
+				lo = cv::Vec2f::all(std::numeric_limits<float>::infinity());
+				hi = -lo;
+				for (int k = 0; k != n; ++k) {
+					auto p = in.positions(vertices[k]);
+					if (in.depth(vertices[k]) > 0.f && p[0] > 0.f && std::isfinite(p[0]) && std::isfinite(p[1])) {
+						lo = cv::Vec2f(std::min(lo[0], p[0]), std::min(lo[1], p[1]));
+						hi = cv::Vec2f(std::max(hi[0], p[0]), std::max(hi[1], p[1]));
+						++valid;
+					}
+				}
+				return valid >= 3;
+			}
+
+			// Visit all items (see draw_item) in raster order, or without triangulation in occlusion-compatible order
+			template<class Visit>
+			void traverse_items(TriangleInput const& in, cv::Vec3f epipole, Visit visit)
+			{
+				auto input_size = in.depth.size();
+				int w = input_size.width;
+
+				if (!in.triangulation.empty()) {
+					for (int k = 0; k < static_cast<int>(in.triangulation.size()); ++k) {
+						visit(k);
+					}
+					if (in.horizontalWrap) {
+						for (int i = 0; i < input_size.height - 1; ++i) {
+							visit(-1 - i);
+						}
+					}
+					return;
+				}
+
+				if (epipole == cv::Vec3f()) {
+					for (int i = 0; i < input_size.height - 1; ++i) {
+						for (int j = 0; j < input_size.width - 1; ++j) {
+							visit(i * w + j);
+						}
+					}
+					return;
+				}
+
+				// McMillan's occlusion-compatible order, reversed: the cells are traversed away from a positive epipole and toward
+				// a negative one, such that nearer triangles are drawn first and the pixels of farther triangles fail the depth test
+				// An epipole at infinity (w = 0) is the limit of both
+				auto away = epipole[2] >= 0.f;
+				auto e_w = epipole[2] == 0.f ? 1e-12f : epipole[2];
+				auto rows = traversal_runs(input_size.height - 1, epipole[1] / e_w, away);
+				auto cols = traversal_runs(input_size.width - 1, epipole[0] / e_w, away);
+				for (auto const& row_run : rows) {
+					for (auto const& col_run : cols) {
+						for (int i : row_run) {
+							for (int j : col_run) {
+								visit(i * w + j);
+							}
+						}
+					}
+				}
+			}
+
+			// Divide the input view in triangles, or use the given triangulation, and rasterize them (see colorize_triangle)
+			template<bool with_color>
+			void rasterize_triangles(TriangleInput const& in, TriangleOutput& out, cv::Vec3f epipole)
+			{
+				traverse_items(in, epipole, [&](int item) { draw_item<with_color>(in, out, item); });
+			}
+
+			// Resolve oversampled maps: each output pixel gets the mean of its samples with a quality > 0, or no color, an infinite depth and zero quality
+			// The color is only resolved when out_color is not empty
+			void resolve_into(cv::Mat3f color, cv::Mat1f depth, cv::Mat1f quality, int factor, cv::Mat3f out_color, cv::Mat1f out_depth, cv::Mat1f out_quality)
+			{
+				for (int y = 0; y < out_depth.rows; ++y) {
+					for (int x = 0; x < out_depth.cols; ++x) {
+						auto sum_color = cv::Vec3f::all(0.f);
+						auto sum_depth = 0.f;
+						auto sum_quality = 0.f;
+						auto n = 0;
+						for (int dy = 0; dy < factor; ++dy) {
+							for (int dx = 0; dx < factor; ++dx) {
+								auto q = quality(y * factor + dy, x * factor + dx);
+								if (q > 0.f) {
+									sum_quality += q;
+									sum_depth += depth(y * factor + dy, x * factor + dx);
+									if (!out_color.empty()) {
+										sum_color += color(y * factor + dy, x * factor + dx);
+									}
+									++n;
+								}
 							}
 						}
+						out_depth(y, x) = n ? sum_depth / n : std::numeric_limits<float>::infinity();
+						out_quality(y, x) = n ? sum_quality / n : 0.f;
+						if (!out_color.empty()) {
+							out_color(y, x) = n ? sum_color / n : cv::Vec3f::all(0.f);
+						}
 					}
+				}
+			}
+
+			// Rasterize tile by tile at the oversampled resolution, and resolve each tile to the output resolution
+			template<bool with_color>
+			void rasterize_tiled(TriangleInput const& in, cv::Vec3f epipole, int factor, cv::Size output_size, cv::Mat3f& color, cv::Mat1f& depth, cv::Mat1f& quality)
+			{
+				// Width of a tile in output pixels
+				int const tile = 64;
+				auto const tiles = cv::Size((output_size.width + tile - 1) / tile, (output_size.height + tile - 1) / tile);
+				auto const span = static_cast<float>(tile * factor);
+
+				// Tile index of an oversampled position, clamped to -1 .. n
+				auto tile_index = [span](float v, int n) {
+					return static_cast<int>(std::min(std::max(std::floor(v / span), -1.f), static_cast<float>(n)));
+				};
+
+				// Bin the items per tile, in traversal order
+				std::vector<std::vector<int>> bins(tiles.area());
+				traverse_items(in, epipole, [&](int item) {
+					cv::Vec2f lo, hi;
+					if (item_bounds(in, item, lo, hi)) {
+						auto x0 = std::max(0, tile_index(lo[0], tiles.width));
+						auto y0 = std::max(0, tile_index(lo[1], tiles.height));
+						auto x1 = std::min(tiles.width - 1, tile_index(hi[0], tiles.width));
+						auto y1 = std::min(tiles.height - 1, tile_index(hi[1], tiles.height));
+						for (int y = y0; y <= y1; ++y) {
+							for (int x = x0; x <= x1; ++x) {
+								bins[y * tiles.width + x].push_back(item);
+							}
+						}
+					}
+				});
+
+				color = with_color ? cv::Mat3f(output_size) : cv::Mat3f();
+				depth = cv::Mat1f(output_size);
+				quality = cv::Mat1f(output_size);
+
+				// Only the buffers of the tiles in flight are oversampled
+#pragma omp parallel for schedule(dynamic)
+				for (int t = 0; t < tiles.area(); ++t) {
+					auto rect = cv::Rect((t % tiles.width) * tile, (t / tiles.width) * tile, tile, tile) & cv::Rect(cv::Point(), output_size);
+					auto size = cv::Size(rect.width * factor, rect.height * factor);
+
+					TriangleOutput out;
+					if (with_color) {
+						out.color = cv::Mat3f::zeros(size);
+					}
+					out.depth = cv::Mat1f(size, std::numeric_limits<float>::infinity());
+					out.shape = cv::Mat1f::zeros(size);
+					out.prologation = cv::Mat1b::ones(size);
+					out.origin = cv::Vec2f(static_cast<float>(rect.x * factor), static_cast<float>(rect.y * factor));
+
+					for (auto item : bins[t]) {
+						draw_item<with_color>(in, out, item);
+					}
+
+					resolve_into(out.color, out.depth, out.shape, factor, with_color ? color(rect) : cv::Mat3f(), depth(rect), quality(rect));
+				}
+			}
+
+			// Whether the block of s x s cells at (x0, y0) is planar: the inverse depth of all its vertices is within the tolerance of the plane through three corners
+			bool is_planar(cv::Mat1f const& depth, int x0, int y0, int s, float tolerance)
+			{
+				auto q00 = 1.f / depth(y0, x0);
+				auto gx = (1.f / depth(y0, x0 + s) - q00) / s;
+				auto gy = (1.f / depth(y0 + s, x0) - q00) / s;
+
+				for (int y = 0; y <= s; ++y) {
+					for (int x = 0; x <= s; ++x) {
+						auto d = depth(y0 + y, x0 + x);
+						if (!(d > 0.f) || std::isinf(d)) {
+							return false;
+						}
+						auto q = q00 + gx * x + gy * y;
+						if (!(std::abs(d * q - 1.f) <= tolerance)) {
+							return false;
+						}
+					}
+				}
+				return true;
+			}
+
+			// Quadtree: keep the block of s x s cells at (x0, y0) when it is planar or a single cell, otherwise divide it in four
+			void collect_blocks(cv::Mat1f const& depth, int x0, int y0, int s, float tolerance, std::vector<cv::Vec3i>& blocks)
+			{
+				auto cells = cv::Size(depth.cols - 1, depth.rows - 1);
+				if (x0 >= cells.width || y0 >= cells.height) {
+					return;
+				}
+				if (s == 1 || (x0 + s <= cells.width && y0 + s <= cells.height && is_planar(depth, x0, y0, s, tolerance))) {
+					blocks.push_back(cv::Vec3i(x0, y0, s));
+					return;
+				}
+				auto h = s / 2;
+				collect_blocks(depth, x0, y0, h, tolerance, blocks);
+				collect_blocks(depth, x0 + h, y0, h, tolerance, blocks);
+				collect_blocks(depth, x0, y0 + h, h, tolerance, blocks);
+				collect_blocks(depth, x0 + h, y0 + h, h, tolerance, blocks);
 			}
 		} // namespace
 
-		cv::Mat3f transform_trianglesMethod(cv::Mat3f input_color, cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& triangle_shape, bool horizontalWrap)
+		Triangulation decimate_depth(cv::Mat1f depth, float tolerance, int max_block_size)
+		{
+			if (max_block_size < 1 || (max_block_size & (max_block_size - 1)) != 0) {
+				throw std::logic_error("The block size of the mesh decimation should be a power of two");
+			}
+
+			Triangulation triangles;
+			if (depth.cols < 2 || depth.rows < 2) {
+				return triangles;
+			}
+			int const w = depth.cols;
+
+			// Blocks (x, y, size) of the quadtree, per row of largest blocks
+			int const rows = (depth.rows - 2) / max_block_size + 1;
+			std::vector<std::vector<cv::Vec3i>> blocks(rows);
+#pragma omp parallel for
+			for (int r = 0; r < rows; ++r) {
+				for (int x0 = 0; x0 < depth.cols - 1; x0 += max_block_size) {
+					collect_blocks(depth, x0, r * max_block_size, max_block_size, tolerance, blocks[r]);
+				}
+			}
+
+			// Vertices of the triangulation: the corners of the blocks
+			cv::Mat1b used = cv::Mat1b::zeros(depth.size());
+			for (auto const& row : blocks) {
+				for (auto const& block : row) {
+					used(block[1], block[0]) = used(block[1], block[0] + block[2]) = 1;
+					used(block[1] + block[2], block[0]) = used(block[1] + block[2], block[0] + block[2]) = 1;
+				}
+			}
+
+			for (auto const& row : blocks) {
+				for (auto const& block : row) {
+					int x0 = block[0];
+					int y0 = block[1];
+					int s = block[2];
+
+					if (s == 1) {
+						triangles.push_back(cv::Vec3i(y0 * w + x0, y0 * w + x0 + 1, (y0 + 1) * w + x0));
+						triangles.push_back(cv::Vec3i((y0 + 1) * w + x0 + 1, (y0 + 1) * w + x0, y0 * w + x0 + 1));
+						continue;
+					}
+
+					// Fan around the center through the border vertices in order, including those of smaller neighbouring blocks (no T-junctions)
+					std::vector<int> border;
+					for (int x = x0; x < x0 + s; ++x) {
+						if (used(y0, x)) border.push_back(y0 * w + x);
+					}
+					for (int y = y0; y < y0 + s; ++y) {
+						if (used(y, x0 + s)) border.push_back(y * w + x0 + s);
+					}
+					for (int x = x0 + s; x > x0; --x) {
+						if (used(y0 + s, x)) border.push_back((y0 + s) * w + x);
+					}
+					for (int y = y0 + s; y > y0; --y) {
+						if (used(y, x0)) border.push_back(y * w + x0);
+					}
+
+					int center = (y0 + s / 2) * w + x0 + s / 2;
+					for (size_t k = 0; k < border.size(); ++k) {
+						triangles.push_back(cv::Vec3i(center, border[k], border[(k + 1) % border.size()]));
+					}
+				}
+			}
+
+			return triangles;
+		}
+
+		cv::Mat3f transform_trianglesMethod(cv::Mat3f input_color, cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& triangle_shape, bool horizontalWrap, float rescale, Triangulation const& triangulation, cv::Vec3f epipole, RasterStatistics* statistics)
 		{
-			auto input_size = input_color.size();
-			int w = input_size.width;
 			cv::Mat1b input_depth_mask = input_depth > 0.f;
-			cv::Mat3f color = cv::Mat3f::zeros(output_size);
-			depth = cv::Mat1f(output_size, std::numeric_limits<float>::infinity());
-			triangle_shape = cv::Mat1f::zeros(output_size);
-			cv::Mat1b new_depth_prologation_mask = cv::Mat1b::ones(output_size);
-
-			// Compute triangulation
-			for (int i = 0; i < input_size.height - 1; ++i) {
-				for (int j = 0; j < input_size.width - 1; ++j) {
-					if (input_depth(i, j + 1) > 0.f && input_depth(i + 1, j) > 0.f && /*why?*/ input_positions(i, j + 1)[0] > 0.f && /*why?*/ input_positions(i + 1, j)[0] > 0.f) {
-						if (input_depth(i, j) > 0.f && /*why?*/ input_positions(i, j)[0] > 0.f)
-							colorize_triangle(input_color, input_depth, input_depth_mask, input_positions, color, depth, new_depth_prologation_mask, triangle_shape,
-								cv::Point(j, i), cv::Point(j + 1, i), cv::Point(j, i + 1));
-						if (input_depth(i + 1, j + 1) > 0.f && input_positions(i + 1, j + 1)[0] > 0.f)
-							colorize_triangle(input_color, input_depth, input_depth_mask, input_positions, color, depth, new_depth_prologation_mask, triangle_shape,
-								cv::Point(j + 1, i + 1), cv::Point(j, i + 1), cv::Point(j + 1, i));
-
-						// stitch left and right borders with triangles (e.g. for equirectangular projection)
-						if (horizontalWrap && j == 0) {
-							colorize_triangle(input_color, input_depth, input_depth_mask, input_positions, color, depth, new_depth_prologation_mask, triangle_shape,
-								cv::Point(w - 1, i), cv::Point(0, i), cv::Point(w - 1, i + 1));
-							colorize_triangle(input_color, input_depth, input_depth_mask, input_positions, color, depth, new_depth_prologation_mask, triangle_shape,
-								cv::Point(0, i + 1), cv::Point(w - 1, i + 1), cv::Point(0, i));
+			TriangleInput in = { input_color, input_depth, input_depth_mask, input_positions, triangulation, horizontalWrap, rescale };
+
+			TriangleOutput out;
+			out.color = cv::Mat3f::zeros(output_size);
+			out.depth = cv::Mat1f(output_size, std::numeric_limits<float>::infinity());
+			out.shape = cv::Mat1f::zeros(output_size);
+			out.prologation = cv::Mat1b::ones(output_size);
+
+			rasterize_triangles<true>(in, out, epipole);
+
+			depth = out.depth;
+			triangle_shape = out.shape;
+			if (statistics) {
+				*statistics = out.statistics;
+			}
+			return out.color;
+		}
+
+		void rasterize_trianglesDepth(cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& triangle_shape, bool horizontalWrap, float rescale, Triangulation const& triangulation, cv::Vec3f epipole, RasterStatistics* statistics)
+		{
+			cv::Mat1b input_depth_mask = input_depth > 0.f;
+			TriangleInput in = { cv::Mat3f(), input_depth, input_depth_mask, input_positions, triangulation, horizontalWrap, rescale };
+
+			TriangleOutput out;
+			out.depth = cv::Mat1f(output_size, std::numeric_limits<float>::infinity());
+			out.shape = cv::Mat1f::zeros(output_size);
+			out.prologation = cv::Mat1b::ones(output_size);
+
+			rasterize_triangles<false>(in, out, epipole);
+
+			depth = out.depth;
+			triangle_shape = out.shape;
+			if (statistics) {
+				*statistics = out.statistics;
+			}
+		}
+
+		cv::Mat3f transform_trianglesTiled(cv::Mat3f input_color, cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& quality, bool horizontalWrap, int rescale, Triangulation const& triangulation, cv::Vec3f epipole)
+		{
+			cv::Mat1b input_depth_mask = input_depth > 0.f;
+			TriangleInput in = { input_color, input_depth, input_depth_mask, input_positions, triangulation, horizontalWrap, static_cast<float>(rescale) };
+
+			cv::Mat3f color;
+			rasterize_tiled<true>(in, epipole, rescale, output_size, color, depth, quality);
+			return color;
+		}
+
+		void rasterize_trianglesDepthTiled(cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& quality, bool horizontalWrap, int rescale, Triangulation const& triangulation, cv::Vec3f epipole)
+		{
+			cv::Mat1b input_depth_mask = input_depth > 0.f;
+			TriangleInput in = { cv::Mat3f(), input_depth, input_depth_mask, input_positions, triangulation, horizontalWrap, static_cast<float>(rescale) };
+
+			cv::Mat3f no_color;
+			rasterize_tiled<false>(in, epipole, rescale, output_size, no_color, depth, quality);
+		}
+
+		cv::Mat3f resolve_oversampling(cv::Mat3f color, cv::Mat1f depth, cv::Mat1f quality, int rescale, cv::Mat1f& resolved_depth, cv::Mat1f& resolved_quality)
+		{
+			auto output_size = cv::Size(depth.cols / rescale, depth.rows / rescale);
+			cv::Mat3f resolved_color(output_size);
+			resolved_depth = cv::Mat1f(output_size);
+			resolved_quality = cv::Mat1f(output_size);
+
+			// Row bands in parallel
+			int const band = 16;
+#pragma omp parallel for
+			for (int y = 0; y < output_size.height; y += band) {
+				auto rect = cv::Rect(0, y, output_size.width, std::min(band, output_size.height - y));
+				auto samples = cv::Rect(0, y * rescale, output_size.width * rescale, rect.height * rescale);
+				resolve_into(color(samples), depth(samples), quality(samples), rescale, resolved_color(rect), resolved_depth(rect), resolved_quality(rect));
+			}
+			return resolved_color;
+		}
+
+		cv::Mat3f transform_splatMethod(cv::Mat3f input_color, cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& quality, bool horizontalWrap, float rescale, float splat_size)
+		{
+			auto const input_size = input_depth.size();
+			auto const none = std::numeric_limits<std::uint64_t>::max();
+			auto const max_half = 2.f * rescale;
+
+			// Z-buffer of the output view: depth (upper 32 bits, positive floats sort as integers) and input pixel index
+			std::vector<std::atomic<std::uint64_t>> zbuffer(output_size.area());
+#pragma omp parallel for
+			for (int k = 0; k < output_size.area(); ++k) {
+				zbuffer[k].store(none, std::memory_order_relaxed);
+			}
+
+			// Quality of each input pixel, from the distance to its warped neighbours (as the stretch of a triangle)
+			cv::Mat1f input_quality(input_size, 0.f);
+
+#pragma omp parallel for
+			for (int i = 0; i < input_size.height; ++i) {
+				for (int j = 0; j < input_size.width; ++j) {
+					auto d = input_depth(i, j);
+					auto center = input_positions(i, j);
+					if (!(d > 0.f) || std::isinf(d) || !(center[0] > 0.f) || std::isnan(center[1])) {
+						continue;
+					}
+
+					// Distance to the right and bottom neighbours, skipping invalid ones and the seam of a wrapped view
+					auto stretch = 0.f;
+					auto found = false;
+					for (auto neighbour : { cv::Point(j + 1, i), cv::Point(j, i + 1) }) {
+						if (neighbour.x < input_size.width && neighbour.y < input_size.height && input_depth(neighbour) > 0.f) {
+							auto distance = static_cast<float>(cv::norm(input_positions(neighbour) - center));
+							if (distance < 0.5f * output_size.width) {
+								stretch = std::max(stretch, distance);
+								found = true;
+							}
+						}
+					}
+					if (!found) {
+						stretch = rescale;
+					}
+					input_quality(i, j) = stretch_quality(stretch, rescale);
+
+					// Footprint: a fixed size, or the stretch (limited to avoid streaks at depth discontinuities)
+					auto half = splat_size > 0.f
+						? 0.5f * splat_size * rescale
+						: std::min(max_half, std::max(0.5f, 0.5f * stretch));
+					auto x0 = static_cast<int>(std::ceil(center[0] - half - 0.5f));
+					auto x1 = static_cast<int>(std::floor(center[0] + half - 0.5f));
+					auto y0 = std::max(0, static_cast<int>(std::ceil(center[1] - half - 0.5f)));
+					auto y1 = std::min(output_size.height - 1, static_cast<int>(std::floor(center[1] + half - 0.5f)));
+
+					std::uint32_t bits;
+					std::memcpy(&bits, &d, sizeof(bits));
+					auto key = (static_cast<std::uint64_t>(bits) << 32) | static_cast<std::uint32_t>(i * input_size.width + j);
+
+					for (int y = y0; y <= y1; ++y) {
+						for (int x = x0; x <= x1; ++x) {
+							auto xx = x;
+							if (horizontalWrap) {
+								xx = (x % output_size.width + output_size.width) % output_size.width;
+							}
+							else if (x < 0 || x >= output_size.width) {
+								continue;
+							}
+
+							// Atomic depth test
+							auto& cell = zbuffer[y * output_size.width + xx];
+							auto old = cell.load(std::memory_order_relaxed);
+							while (key < old && !cell.compare_exchange_weak(old, key, std::memory_order_relaxed)) {}
 						}
 					}
 				}
 			}
 
+			// Resolve: fetch the color, depth and quality of the nearest splat
+			cv::Mat3f color(output_size);
+			depth = cv::Mat1f(output_size);
+			quality = cv::Mat1f(output_size);
+#pragma omp parallel for
+			for (int y = 0; y < output_size.height; ++y) {
+				for (int x = 0; x < output_size.width; ++x) {
+					auto key = zbuffer[y * output_size.width + x].load(std::memory_order_relaxed);
+					if (key == none) {
+						color(y, x) = cv::Vec3f::all(0.f);
+						depth(y, x) = std::numeric_limits<float>::infinity();
+						quality(y, x) = 0.f;
+					}
+					else {
+						auto index = static_cast<int>(key & 0xFFFFFFFFu);
+						auto i = index / input_size.width;
+						auto j = index % input_size.width;
+						color(y, x) = input_color(i, j);
+						depth(y, x) = input_depth(i, j);
+						quality(y, x) = input_quality(i, j);
+					}
+				}
+			}
+
 			return color;
 		}
 	}
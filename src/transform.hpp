@@ -47,6 +47,9 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 #include <opencv2/core.hpp>
 
+#include <cstddef>
+#include <vector>
+
 namespace rvs 
 {
 	namespace detail 
@@ -56,6 +59,46 @@ namespace rvs
 		\brief The file containing the warping functions
 		*/
 
+		/**
+		\brief Triangles over the pixel grid of a view, each as the indices (row * width + column) of its three vertices
+
+		The vertices are the centers of the pixels, as for the full triangulation of transform_trianglesMethod().
+		*/
+		typedef std::vector<cv::Vec3i> Triangulation;
+
+		/**
+		\brief Adaptive triangulation of a depth map (mesh decimation)
+
+		A quadtree is built over the pixel grid: blocks of up to max_block_size pixels wide which are planar (the inverse
+		depth of all vertices is within the tolerance of the plane through three corners) are merged, and triangulated
+		as a fan around their center. Fans include the vertices of smaller neighbouring blocks, such that there are
+		no cracks. Other cells are divided in two triangles, as without decimation.
+
+		The inverse depth of a plane is only linear in the image coordinates of a perspective view, so the depth map should be
+		perspective.
+
+		@param depth Input depth map; valid values are > 0 (invalid may be NaN or <= 0)
+		@param tolerance Relative tolerance on the depth of merged vertices, e.g. 0.01
+		@param max_block_size Width of the largest merged blocks in pixels (power of two)
+		@return The triangles, in the orientation of transform_trianglesMethod()
+		*/
+		Triangulation decimate_depth(cv::Mat1f depth, float tolerance, int max_block_size);
+
+		/**
+		\brief Counters of the rasterization of triangles, e.g. to measure overdraw
+		*/
+		struct RasterStatistics
+		{
+			/** Number of triangles that are front-facing and inside the output */
+			std::size_t triangles = 0;
+
+			/** Number of pixels covered by the triangles (each one depth test) */
+			std::size_t tests = 0;
+
+			/** Number of pixels written */
+			std::size_t writes = 0;
+		};
+
 		/**
 		\brief Translate and rotate the camera in any 3D direction according to the input position map
 
@@ -70,9 +113,94 @@ namespace rvs
 		@param[out] depth Output depth map
 		@param[out] quality Quality metric to drive blending; involves depth and shape of warped triangles (elongated and big = low quality)
 		@param horizontalWrap
+		@param rescale Precision (oversampling factor) to normalize the stretch of the triangles
+		@param triangulation Triangles to rasterize (see decimate_depth()), or empty for all pixels
+		@param epipole Position of the virtual camera center in the input image in homogeneous pixel coordinates (x w, y w, w), with w < 0
+		behind the input camera. The pixels are then traversed in the reverse of McMillan's occlusion-compatible order (nearest first),
+		to reduce overdraw. Only for the full triangulation of a perspective input view; all zeros for raster order
+		@param[out] statistics Counters of triangles, depth tests and writes (optional)
+		@return Output color map
+		*/
+		cv::Mat3f transform_trianglesMethod(cv::Mat3f input_color, cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& quality, bool horizontalWrap, float rescale, Triangulation const& triangulation = Triangulation(), cv::Vec3f epipole = cv::Vec3f(), RasterStatistics* statistics = nullptr);
+
+		/**
+		\brief Rasterize only the depth and quality of the warped triangles (see transform_trianglesMethod())
+
+		This is the first stage of the backward warping method: the color is fetched afterwards for each output pixel.
+
+		@param input_depth Input depth map; valid values are > 0 (invalid may be NaN or <= 0)
+		@param input_positions Warped coordinate map (result of unproject -> rotate/translate -> project)
+		@param output_size Output size
+		@param[out] depth Output depth map, infinity where no triangle is rasterized
+		@param[out] quality Quality metric to drive blending (see transform_trianglesMethod()), 0 where no triangle is rasterized
+		@param horizontalWrap
+		@param rescale Precision (oversampling factor) to normalize the stretch of the triangles
+		@param triangulation Triangles to rasterize (see decimate_depth()), or empty for all pixels
+		@param epipole Traversal order (see transform_trianglesMethod())
+		@param[out] statistics Counters of triangles, depth tests and writes (optional)
+		*/
+		void rasterize_trianglesDepth(cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& quality, bool horizontalWrap, float rescale, Triangulation const& triangulation = Triangulation(), cv::Vec3f epipole = cv::Vec3f(), RasterStatistics* statistics = nullptr);
+
+		/**
+		\brief Translate and rotate the camera with oversampling inside the rasterizer only (see transform_trianglesMethod())
+
+		The output is divided in tiles of 64 x 64 pixels which are rasterized in parallel at the oversampled resolution, and each tile
+		is resolved to the output resolution (see resolve_oversampling()). Only the buffers of the tiles in flight are oversampled,
+		such that the blending and inpainting run at the output resolution.
+
+		@param input_color Input color map
+		@param input_depth Input depth map; valid values are > 0 (invalid may be NaN or <= 0)
+		@param input_positions Warped coordinate map at the oversampled resolution
+		@param output_size Output size of the color image (not oversampled)
+		@param[out] depth Output depth map, infinity where no triangle is rasterized
+		@param[out] quality Quality metric to drive blending, 0 where no triangle is rasterized
+		@param horizontalWrap
+		@param rescale Precision (integer oversampling factor)
+		@param triangulation Triangles to rasterize (see decimate_depth()), or empty for all pixels
+		@param epipole Traversal order (see transform_trianglesMethod())
+		@return Output color map
+		*/
+		cv::Mat3f transform_trianglesTiled(cv::Mat3f input_color, cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& quality, bool horizontalWrap, int rescale, Triangulation const& triangulation = Triangulation(), cv::Vec3f epipole = cv::Vec3f());
+
+		/**
+		\brief Rasterize only the depth and quality of the warped triangles, tile by tile (see transform_trianglesTiled())
+		*/
+		void rasterize_trianglesDepthTiled(cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& quality, bool horizontalWrap, int rescale, Triangulation const& triangulation = Triangulation(), cv::Vec3f epipole = cv::Vec3f());
+
+		/**
+		\brief Resolve oversampled color, depth and quality maps to the output resolution
+
+		Each output pixel is the mean of its rescale x rescale samples with a quality > 0; without such samples it has no color,
+		an infinite depth and zero quality.
+
+		@param color Oversampled color map
+		@param depth Oversampled depth map
+		@param quality Oversampled quality map
+		@param rescale Precision (integer oversampling factor)
+		@param[out] resolved_depth Output depth map
+		@param[out] resolved_quality Output quality map
+		@return Output color map
+		*/
+		cv::Mat3f resolve_oversampling(cv::Mat3f color, cv::Mat1f depth, cv::Mat1f quality, int rescale, cv::Mat1f& resolved_depth, cv::Mat1f& resolved_quality);
+
+		/**
+		\brief Forward-project each input pixel as a square splat with a z-buffer
+
+		Cheaper than transform_trianglesMethod(), e.g. for previews. The splats are drawn in parallel with an atomic depth test;
+		for equal depths the input pixel with the lowest index wins, such that the result is deterministic.
+
+		@param input_color Input color map
+		@param input_depth Warped depth map; valid values are > 0 (invalid may be NaN or <= 0)
+		@param input_positions Warped coordinate map (result of unproject -> rotate/translate -> project)
+		@param output_size Output size of the color image
+		@param[out] depth Output depth map, infinity where no splat is drawn
+		@param[out] quality Quality metric to drive blending, from the distance between warped neighbours (as the stretch of a triangle), 0 where no splat is drawn
+		@param horizontalWrap
+		@param rescale Precision (oversampling factor)
+		@param splat_size Width of a splat in pixels of the virtual view, or 0 for the distance between warped neighbours (at most 4 pixels)
 		@return Output color map
 		*/
-		cv::Mat3f transform_trianglesMethod(cv::Mat3f input_color, cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& quality, bool horizontalWrap);
+		cv::Mat3f transform_splatMethod(cv::Mat3f input_color, cv::Mat1f input_depth, cv::Mat2f input_positions, cv::Size output_size, cv::Mat1f& depth, cv::Mat1f& quality, bool horizontalWrap, float rescale, float splat_size);
 	}
 }
 
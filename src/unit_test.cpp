@@ -50,8 +50,14 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 #include "PerspectiveUnprojector.hpp"
 #include "EquirectangularProjector.hpp"
 #include "EquirectangularUnprojector.hpp"
+#include "SpaceTransformer.hpp"
 #include "PoseTraces.hpp"
 #include "JsonParser.hpp"
+#include "culling.hpp"
+#include "transform.hpp"
+#include "blending.hpp"
+#include "BlendedView.hpp"
+#include "SynthesizedView.hpp"
 
 #include <opencv2/opencv.hpp>
 
@@ -307,6 +313,47 @@ FUNC(Test_PerspectiveProjector_project)
 	CHECK(actualWrappingMethod == rvs::WrappingMethod::none);
 }
 
+FUNC(Test_GenericTransformer_warp)
+{
+	// Warp a perspective view to an equirectangular view at twice the resolution
+	auto input = testing::persp::generateParameters();
+	auto output = testing::erp::generateParameters();
+	output.setPosition(cv::Vec3f(1.f, -2.f, 3.f));
+	rvs::GenericTransformer transformer;
+	transformer.set_inputPosition(&input);
+	transformer.set_targetPosition(&output);
+	auto outputSize = 2 * output.getSize();
+
+	cv::Mat3f worldPos;
+	cv::Mat1f actualDepth;
+	rvs::WrappingMethod actualWrappingMethod = rvs::WrappingMethod::none;
+	auto depth = testing::persp::generateReferenceDepth();
+	auto actualImagePos = transformer.warp(depth, outputSize, worldPos, actualDepth, actualWrappingMethod);
+
+	// Reference: unproject, transform and project in separate passes
+	auto referenceWorldPos = transformer.unproject(transformer.generateImagePos(), depth);
+	auto R = transformer.get_rotation();
+	auto t = transformer.get_translation();
+	cv::Mat3f virtualWorldPos(referenceWorldPos.size());
+	for (int i = 0; i != virtualWorldPos.rows; ++i) {
+		for (int j = 0; j != virtualWorldPos.cols; ++j) {
+			virtualWorldPos(i, j) = R * referenceWorldPos(i, j) + t;
+		}
+	}
+	cv::Mat1f referenceDepth;
+	rvs::WrappingMethod referenceWrappingMethod;
+	cv::Mat2f referenceImagePos = 2.f * transformer.project(virtualWorldPos, referenceDepth, referenceWrappingMethod);
+
+	CHECK(cv::norm(referenceWorldPos, worldPos, cv::NORM_INF) < 1e-5f);
+	CHECK(cv::norm(referenceImagePos, actualImagePos, cv::NORM_INF) < 1e-4f);
+	CHECK(cv::norm(referenceDepth, actualDepth, cv::NORM_INF) < 1e-5f);
+	CHECK(actualWrappingMethod == referenceWrappingMethod);
+
+	// Warping again reuses the world positions
+	auto cachedImagePos = transformer.warp(cv::Mat1f(), outputSize, worldPos, actualDepth, actualWrappingMethod);
+	CHECK(cv::norm(actualImagePos, cachedImagePos, cv::NORM_INF) < 1e-6f);
+}
+
 FUNC(Test_JsonParser_readFrom)
 {
 	std::istringstream stream(R"(
@@ -387,6 +434,419 @@ FUNC(Test_PoseTrace_loadFrom)
 	EQUAL(poseTrace[3].rotation[2], 16.5f);
 }
 
+FUNC(Test_isOverlapping)
+{
+	std::istringstream text(R"({
+		"Name"				: "v0",
+		"Projection"		: "Perspective",
+		"Position"			: [0, 0, 0],
+		"Rotation"			: [0, 0, 0],
+		"Depthmap"			: 1,
+		"Background"		: 0,
+		"Depth_range"		: [1, 10],
+		"Resolution"		: [4, 3],
+		"Focal"				: [3, 3],
+		"Principle_point"	: [2, 1.5],
+		"BitDepthColor"		: 10,
+		"BitDepthDepth"		: 10,
+		"ColorSpace"		: "YUV420",
+		"DepthColorSpace"	: "YUV420"
+	})");
+	auto input = rvs::Parameters::readFrom(json::Node::readFrom(text));
+	auto bound = rvs::detail::boundInputView(input);
+	EQUAL(bound.size(), 8u);
+
+	// Same camera, slightly turned or moved
+	auto virtualCamera = input;
+	CHECK(rvs::detail::isOverlapping(input, virtualCamera));
+	virtualCamera.setRotation(cv::Vec3f(30.f, 0.f, 0.f));
+	CHECK(rvs::detail::isOverlapping(input, virtualCamera));
+	virtualCamera.setPosition(cv::Vec3f(-5.f, 0.f, 0.f));
+	CHECK(rvs::detail::isOverlapping(input, virtualCamera));
+
+	// Camera facing away
+	virtualCamera.setPosition(cv::Vec3f(0.f, 0.f, 0.f));
+	virtualCamera.setRotation(cv::Vec3f(180.f, 0.f, 0.f));
+	CHECK(!rvs::detail::isOverlapping(input, virtualCamera));
+
+	// Camera behind the far plane
+	virtualCamera.setPosition(cv::Vec3f(20.f, 0.f, 0.f));
+	virtualCamera.setRotation(cv::Vec3f(0.f, 0.f, 0.f));
+	CHECK(!rvs::detail::isOverlapping(input, virtualCamera));
+
+	// Full equirectangular virtual views see everything
+	auto erp = testing::erp::generateParameters();
+	CHECK(rvs::detail::isOverlapping(input, erp));
+	CHECK(rvs::detail::isOverlapping(erp, input));
+}
+
+FUNC(Test_transform_splatMethod)
+{
+	auto const NaN = std::numeric_limits<float>::quiet_NaN();
+	cv::Mat3f color(1, 3);
+	color(0, 0) = cv::Vec3f(1.f, 0.f, 0.f);
+	color(0, 1) = cv::Vec3f(0.f, 1.f, 0.f);
+	color(0, 2) = cv::Vec3f(0.f, 0.f, 1.f);
+	cv::Mat1f depth(1, 3);
+	depth(0, 0) = 2.f;
+	depth(0, 1) = 1.f;
+	depth(0, 2) = NaN;
+	cv::Mat2f positions(1, 3);
+	positions(0, 0) = cv::Vec2f(1.5f, 0.5f);
+	positions(0, 1) = cv::Vec2f(1.5f, 0.5f);
+	positions(0, 2) = cv::Vec2f(3.5f, 0.5f);
+
+	// Two pixels on the same output pixel: the nearest one wins, the invalid pixel is not drawn
+	cv::Mat1f new_depth, quality;
+	auto new_color = rvs::detail::transform_splatMethod(color, depth, positions, cv::Size(4, 1), new_depth, quality, false, 1.f, 1.f);
+	CHECK(new_color(0, 1) == cv::Vec3f(0.f, 1.f, 0.f));
+	EQUAL(new_depth(0, 1), 1.f);
+	CHECK(quality(0, 1) > 0.f);
+	for (int x : { 0, 2, 3 }) {
+		EQUAL(quality(0, x), 0.f);
+		CHECK(std::isinf(new_depth(0, x)));
+	}
+
+	// A wider splat on the right border wraps around for equirectangular views
+	positions(0, 1) = cv::Vec2f(4.f, 0.5f);
+	new_color = rvs::detail::transform_splatMethod(color, depth, positions, cv::Size(4, 1), new_depth, quality, true, 1.f, 2.f);
+	CHECK(new_color(0, 0) == cv::Vec3f(0.f, 1.f, 0.f));
+	CHECK(new_color(0, 3) == cv::Vec3f(0.f, 1.f, 0.f));
+	CHECK(new_color(0, 1) == cv::Vec3f(1.f, 0.f, 0.f));
+}
+
+FUNC(Test_decimate_depth)
+{
+	// Sum of the areas of the triangles in input pixels, or -1 when a triangle has the wrong orientation
+	auto area = [](rvs::detail::Triangulation const& triangles, int w) {
+		auto sum = 0.f;
+		for (auto const& t : triangles) {
+			cv::Point2f a(float(t[0] % w), float(t[0] / w));
+			cv::Point2f b(float(t[1] % w), float(t[1] / w));
+			cv::Point2f c(float(t[2] % w), float(t[2] / w));
+			auto den = (b.y - c.y) * (a.x - c.x) + (c.x - b.x) * (a.y - c.y);
+			if (den <= 0.f) {
+				return -1.f;
+			}
+			sum += 0.5f * den;
+		}
+		return sum;
+	};
+
+	// A plane is one block of four triangles
+	cv::Mat1f depth(9, 9, 2.f);
+	auto triangles = rvs::detail::decimate_depth(depth, 0.01f, 8);
+	EQUAL(triangles.size(), 4u);
+	EQUAL(area(triangles, 9), 64.f);
+
+	// Around a bump the blocks are smaller, and larger neighbours include their vertices (no cracks)
+	depth(6, 6) = 3.f;
+	triangles = rvs::detail::decimate_depth(depth, 0.01f, 8);
+	CHECK(triangles.size() > 4u);
+	CHECK(triangles.size() < 2u * 8u * 8u);
+	EQUAL(area(triangles, 9), 64.f);
+
+	// Rasterizing a plane with or without decimation gives the same result
+	depth = cv::Mat1f(9, 9, 2.f);
+	cv::Mat3f color(9, 9);
+	cv::Mat2f positions(9, 9);
+	for (int i = 0; i < 9; ++i) {
+		for (int j = 0; j < 9; ++j) {
+			color(i, j) = cv::Vec3f(j / 8.f, i / 8.f, 0.5f);
+			positions(i, j) = cv::Vec2f(j + 0.5f, i + 0.5f);
+		}
+	}
+	triangles = rvs::detail::decimate_depth(depth, 0.01f, 8);
+	cv::Mat1f full_depth, full_quality, new_depth, quality;
+	auto full_color = rvs::detail::transform_trianglesMethod(color, depth, positions, cv::Size(9, 9), full_depth, full_quality, false, 1.f);
+	auto new_color = rvs::detail::transform_trianglesMethod(color, depth, positions, cv::Size(9, 9), new_depth, quality, false, 1.f, triangles);
+	for (int i = 0; i < 9; ++i) {
+		for (int j = 0; j < 9; ++j) {
+			CHECK(std::abs(quality(i, j) - full_quality(i, j)) < 1e-2f);
+			if (full_quality(i, j) > 0.f) {
+				CHECK(cv::norm(new_color(i, j) - full_color(i, j)) < 1e-4);
+				CHECK(std::abs(new_depth(i, j) - full_depth(i, j)) < 1e-4f);
+			}
+		}
+	}
+}
+
+FUNC(Test_SynthesizedView_prepare)
+{
+	// A plane: one block of four triangles per 32x32 pixels
+	cv::Mat1f depth(33, 65, 2.f);
+	rvs::SynthetisedViewTriangle synthesizer;
+	synthesizer.setMeshDecimation(0.01f);
+
+	// Perspective input views are decimated once, and the triangulation is kept with the view
+	rvs::View perspective(cv::Mat3f(depth.size(), cv::Vec3f::all(0.5f)), depth, cv::Mat1f(depth.size(), 1.f), cv::Mat1f(depth.size(), 1.f));
+	synthesizer.prepare(perspective, testing::persp::generateParameters());
+	auto triangulation = perspective.get_triangulation();
+	CHECK(triangulation != nullptr);
+	EQUAL(triangulation->size(), 8u);
+	synthesizer.prepare(perspective, testing::persp::generateParameters());
+	CHECK(perspective.get_triangulation() == triangulation);
+
+	// The planarity test does not hold for equirectangular input views: all pixels are triangulated
+	rvs::View equirectangular(cv::Mat3f(depth.size(), cv::Vec3f::all(0.5f)), depth, cv::Mat1f(depth.size(), 1.f), cv::Mat1f(depth.size(), 1.f));
+	synthesizer.prepare(equirectangular, testing::erp::generateParameters());
+	CHECK(equirectangular.get_triangulation() == nullptr);
+
+	// Without MeshDecimation neither
+	rvs::View full(cv::Mat3f(depth.size(), cv::Vec3f::all(0.5f)), depth, cv::Mat1f(depth.size(), 1.f), cv::Mat1f(depth.size(), 1.f));
+	synthesizer.setMeshDecimation(0.f);
+	synthesizer.prepare(full, testing::persp::generateParameters());
+	CHECK(full.get_triangulation() == nullptr);
+}
+
+FUNC(Test_transform_occlusionOrder)
+{
+	// A box in front of a wall, seen by a camera moving to the right: the box occludes the wall on its left
+	cv::Mat1f depth(32, 32, 4.f);
+	depth(cv::Rect(8, 8, 16, 16)).setTo(1.f);
+	cv::Mat3f color(32, 32, cv::Vec3f::all(0.5f));
+	cv::Mat2f positions(32, 32);
+	for (int i = 0; i < 32; ++i) {
+		for (int j = 0; j < 32; ++j) {
+			positions(i, j) = cv::Vec2f(j + 0.5f - 16.f / depth(i, j), i + 0.5f);
+		}
+	}
+
+	// The epipole is at infinity on the right: nearest first is from right to left
+	cv::Vec3f epipole(16.f, 0.f, 0.f);
+	rvs::detail::RasterStatistics raster, occlusion;
+	cv::Mat1f raster_depth, raster_quality, new_depth, quality;
+	rvs::detail::transform_trianglesMethod(color, depth, positions, cv::Size(32, 32), raster_depth, raster_quality, false, 1.f, rvs::detail::Triangulation(), cv::Vec3f(), &raster);
+	rvs::detail::transform_trianglesMethod(color, depth, positions, cv::Size(32, 32), new_depth, quality, false, 1.f, rvs::detail::Triangulation(), epipole, &occlusion);
+
+	// Same triangles, less overdraw
+	EQUAL(occlusion.triangles, raster.triangles);
+	EQUAL(occlusion.tests, raster.tests);
+	CHECK(occlusion.writes < raster.writes);
+	EQUAL(raster_depth(16, 0), 1.f);
+	EQUAL(new_depth(16, 0), 1.f);
+}
+
+FUNC(Test_transform_trianglesTiled)
+{
+	// A box in front of a wall, magnified twice and oversampled twice: the output spans several tiles
+	cv::Mat1f depth(70, 80, 4.f);
+	depth(cv::Rect(20, 15, 30, 30)).setTo(1.f);
+	cv::Mat3f color(depth.size());
+	cv::Mat2f positions(depth.size());
+	for (int i = 0; i < depth.rows; ++i) {
+		for (int j = 0; j < depth.cols; ++j) {
+			color(i, j) = cv::Vec3f(j / 80.f, i / 70.f, depth(i, j) / 4.f);
+			positions(i, j) = 4.f * cv::Vec2f(j + 0.5f - 8.f / depth(i, j), i + 0.5f);
+		}
+	}
+
+	// Reference: rasterize the whole oversampled view, then resolve
+	cv::Mat1f oversampled_depth, oversampled_quality;
+	auto oversampled_color = rvs::detail::transform_trianglesMethod(color, depth, positions, cv::Size(320, 280), oversampled_depth, oversampled_quality, false, 2.f);
+	cv::Mat1f expected_depth, expected_quality;
+	auto expected_color = rvs::detail::resolve_oversampling(oversampled_color, oversampled_depth, oversampled_quality, 2, expected_depth, expected_quality);
+	EQUAL(expected_color.size(), cv::Size(160, 140));
+
+	cv::Mat1f new_depth, quality;
+	auto new_color = rvs::detail::transform_trianglesTiled(color, depth, positions, cv::Size(160, 140), new_depth, quality, false, 2);
+	EQUAL(new_color.size(), cv::Size(160, 140));
+	CHECK(cv::norm(new_color, expected_color, cv::NORM_INF) < 1e-4);
+	CHECK(cv::norm(quality, expected_quality, cv::NORM_INF) < 1e-2);
+	EQUAL(cv::countNonZero(quality > 0.f), cv::countNonZero(expected_quality > 0.f));
+
+	// Only the box in front, at the depth of the box
+	CHECK(std::abs(new_depth(60, 80) - 1.f) < 1e-5f);
+	CHECK(std::isinf(new_depth(0, 159)));
+}
+
+FUNC(Test_blend_img)
+{
+	// Two views with random qualities, some pixels without quality and some from extrapolated depth
+	cv::RNG rng(42);
+	std::vector<cv::Mat> colors(2), qualities(2), prolongations(2);
+	for (int i = 0; i != 2; ++i) {
+		colors[i] = cv::Mat3f(17, 23);
+		rng.fill(colors[i], cv::RNG::UNIFORM, 0.f, 1.f);
+		cv::Mat1f quality(17, 23);
+		rng.fill(quality, cv::RNG::UNIFORM, -1.f, 4.f);
+		qualities[i] = cv::max(quality, 0.f);
+		cv::Mat1b prolongation(17, 23);
+		rng.fill(prolongation, cv::RNG::UNIFORM, 0, 2);
+		prolongations[i] = prolongation;
+	}
+
+	for (auto blending_exp : { 1.f, 5.f, 2.5f, 0.f }) {
+		cv::Mat quality, prolongation_mask, inpaint_mask;
+		cv::Mat3f color = rvs::detail::blend_img(colors, qualities, prolongations, cv::Vec3f(0.f, 0.5f, 0.5f), quality, prolongation_mask, inpaint_mask, blending_exp);
+
+		for (int y = 0; y != 17; ++y) {
+			for (int x = 0; x != 23; ++x) {
+				// Weighted mean with powf, original depth first
+				float s[2] = {};
+				cv::Vec3f sum[2];
+				for (int i = 0; i != 2; ++i) {
+					auto q = qualities[i].at<float>(y, x);
+					if (q > 0.f) {
+						auto k = prolongations[i].at<uchar>(y, x) ? 1 : 0;
+						s[k] += powf(q, blending_exp);
+						sum[k] += powf(q, blending_exp) * colors[i].at<cv::Vec3f>(y, x);
+					}
+				}
+				auto k = s[0] > 0.f ? 0 : 1;
+				if (s[k] > 0.f) {
+					CHECK(cv::norm(color(y, x), sum[k] / s[k]) < 1e-5);
+					if (blending_exp == 0.f) {
+						// Mean: 1 for a single view, infinite for more
+						EQUAL(quality.at<float>(y, x), powf(s[k], 1.f / blending_exp));
+					}
+					else {
+						CHECK(std::abs(quality.at<float>(y, x) - powf(s[k], 1.f / blending_exp)) < 1e-4f * quality.at<float>(y, x));
+					}
+					EQUAL(prolongation_mask.at<uchar>(y, x) != 0, k == 1);
+					EQUAL(inpaint_mask.at<uchar>(y, x), 0);
+				}
+				else {
+					EQUAL(color(y, x), cv::Vec3f(0.f, 0.5f, 0.5f));
+					EQUAL(quality.at<float>(y, x), 0.f);
+					CHECK(inpaint_mask.at<uchar>(y, x) != 0);
+				}
+			}
+		}
+	}
+}
+
+FUNC(Test_BlendedViewSimple_packed)
+{
+	// Three views with random qualities, some pixels without quality and some without depth
+	cv::RNG rng(42);
+	std::vector<rvs::View> views;
+	for (int i = 0; i != 3; ++i) {
+		cv::Mat3f color(17, 23);
+		rng.fill(color, cv::RNG::UNIFORM, 0.f, 1.f);
+		cv::Mat1f depth(17, 23);
+		rng.fill(depth, cv::RNG::UNIFORM, -0.5f, 2.f);
+		cv::Mat1f quality(17, 23);
+		rng.fill(quality, cv::RNG::UNIFORM, -1.f, 4.f);
+		cv::Mat1f validity(17, 23);
+		rng.fill(validity, cv::RNG::UNIFORM, 0.f, 10.f);
+		views.push_back(rvs::View(color, depth, cv::max(quality, 0.f), validity));
+	}
+
+	for (auto blending_exp : { 1.f, 2.f, 2.5f }) {
+		rvs::Context context;
+		rvs::BlendedViewSimple separate(blending_exp);
+		separate.setContext(context);
+		context.packed_views = true;
+		rvs::BlendedViewSimple packed(blending_exp);
+		packed.setContext(context);
+		for (auto const& view : views) {
+			separate.blend(view);
+			packed.blend(view);
+		}
+		CHECK(!packed.get_packed().empty());
+
+		// Same result up to the half precision of the color: each blend rounds by at most 2^-12 below 1, so three blends stay
+		// within one level of the 10-bit output that PackedViews allows
+		CHECK(cv::norm(separate.get_color(), packed.get_color(), cv::NORM_INF) < 1. / 1023.);
+		CHECK(cv::norm(separate.get_depth(), packed.get_depth(), cv::NORM_INF) < 1e-6);
+		CHECK(cv::norm(separate.get_quality(), packed.get_quality(), cv::NORM_INF) < 1e-4);
+		CHECK(cv::norm(separate.get_validity(), packed.get_validity(), cv::NORM_INF) < 1e-6);
+		EQUAL(cv::countNonZero(separate.get_inpaint_mask() != packed.get_inpaint_mask()), 0);
+		EQUAL(cv::countNonZero(separate.get_validity_mask(5.f) != packed.get_validity_mask(5.f)), 0);
+	}
+}
+
+FUNC(Test_blend_img_by_max)
+{
+	std::vector<cv::Mat> colors = { cv::Mat3f(1, 3, cv::Vec3f::all(0.25f)), cv::Mat3f(1, 3, cv::Vec3f::all(0.75f)) };
+	std::vector<cv::Mat> qualities = { cv::Mat1f((cv::Mat1f(1, 3) << 2.f, 1.f, 0.f)), cv::Mat1f((cv::Mat1f(1, 3) << 2.f, 3.f, 0.f)) };
+	std::vector<cv::Mat> prolongations = { cv::Mat1b::zeros(1, 3), cv::Mat1b::ones(1, 3) };
+
+	cv::Mat quality, prolongation_mask, inpaint_mask;
+	cv::Mat3f color = rvs::detail::blend_img(colors, qualities, prolongations, cv::Vec3f(0.f, 0.5f, 0.5f), quality, prolongation_mask, inpaint_mask, -1.f);
+
+	// The first input for equal qualities, nothing without quality
+	EQUAL(color(0, 0), cv::Vec3f::all(0.25f));
+	EQUAL(color(0, 1), cv::Vec3f::all(0.75f));
+	EQUAL(color(0, 2), cv::Vec3f(0.f, 0.5f, 0.5f));
+	EQUAL(quality.at<float>(0, 1), 3.f);
+	EQUAL(prolongation_mask.at<uchar>(0, 0), 0);
+	EQUAL(prolongation_mask.at<uchar>(0, 1), 1);
+	EQUAL(cv::countNonZero(inpaint_mask), 1);
+	CHECK(inpaint_mask.at<uchar>(0, 2) != 0);
+}
+
+FUNC(Test_MaskedBoxBlur)
+{
+	cv::RNG rng(7);
+	cv::Mat3f img(19, 31);
+	rng.fill(img, cv::RNG::UNIFORM, 0.f, 1.f);
+	img(4, 5)[1] = std::numeric_limits<float>::quiet_NaN();
+	cv::Mat1b mask(img.size());
+	rng.fill(mask, cv::RNG::UNIFORM, 0, 2);
+	mask *= 255;
+
+	rvs::detail::MaskedBoxBlur blur;
+	for (auto radius : { 0, 3, 40 }) {
+		cv::Mat blurred;
+		blur.apply(img, mask, radius, blurred);
+
+		// Mean over the window of the included pixels
+		for (int y = 0; y != img.rows; ++y) {
+			for (int x = 0; x != img.cols; ++x) {
+				cv::Vec3f sum;
+				auto count = 0;
+				for (int v = std::max(0, y - radius); v <= std::min(img.rows - 1, y + radius); ++v) {
+					for (int u = std::max(0, x - radius); u <= std::min(img.cols - 1, x + radius); ++u) {
+						if (mask(v, u) && !std::isnan(img(v, u)[1])) {
+							sum += img(v, u);
+							++count;
+						}
+					}
+				}
+				auto expected = mask(y, x) && count ? sum / count : cv::Vec3f();
+				CHECK(cv::norm(blurred.at<cv::Vec3f>(y, x), expected) < 1e-5);
+			}
+		}
+	}
+
+	// Single channel, in place: no rounding of the sums
+	cv::Mat1f luma(4, 4, 0.25f);
+	cv::Mat blurred = luma;
+	blur.apply(blurred, cv::Mat1b(4, 4, 255), 1, blurred);
+	EQUAL(blurred.at<float>(2, 2), 0.25f);
+}
+
+FUNC(Test_laplacian_pyramid)
+{
+	cv::RNG rng(3);
+	cv::Mat3f color(90, 120);
+	rng.fill(color, cv::RNG::UNIFORM, 0.f, 1.f);
+	auto levels = rvs::detail::laplacian_pyramid_levels(color.size());
+	EQUAL(levels, 2);
+
+	// One view: the pyramid collapses to the view itself
+	std::vector<cv::Mat3f> bands;
+	std::vector<cv::Mat1f> weights;
+	rvs::detail::accumulate_laplacian_pyramid(color, cv::Mat1f(color.size(), 2.f), levels, bands, weights);
+	CHECK(cv::norm(rvs::detail::collapse_laplacian_pyramid(bands, weights, cv::Vec3f()), color, cv::NORM_INF) < 1e-4);
+
+	// A second view which only covers the left half: the right half keeps the first view
+	cv::Mat1f half = cv::Mat1f::zeros(color.size());
+	half.colRange(0, 60).setTo(1.f);
+	rvs::detail::accumulate_laplacian_pyramid(cv::Mat3f(color.size(), cv::Vec3f::all(0.5f)), half, levels, bands, weights);
+	auto blended = rvs::detail::collapse_laplacian_pyramid(bands, weights, cv::Vec3f());
+	CHECK(cv::norm(blended.colRange(100, 120), color.colRange(100, 120), cv::NORM_INF) < 1e-4);
+	CHECK(std::abs(cv::mean(blended.colRange(0, 40))[0] - (2. * cv::mean(color.colRange(0, 40))[0] + 0.5) / 3.) < 1e-2);
+
+	// No weight: empty color
+	bands.clear();
+	weights.clear();
+	rvs::detail::accumulate_laplacian_pyramid(color, cv::Mat1f::zeros(color.size()), levels, bands, weights);
+	EQUAL(rvs::detail::collapse_laplacian_pyramid(bands, weights, cv::Vec3f(0.f, 1.f, 0.f))(10, 10), cv::Vec3f(0.f, 1.f, 0.f));
+}
+
 int main(int argc, const char* argv[])
 {
 	rvs::g_verbose = true;
@@ -46,10 +46,15 @@ Koninklijke Philips N.V., Eindhoven, The Netherlands:
 
 #if WITH_OPENGL
 #include "helpersGL.hpp"
+#include "Shader.hpp"
 #endif
 
 #include "Analyzer.hpp"
+#ifndef _WIN32
+#include "Server.hpp"
+#endif
 
+#include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
@@ -60,21 +65,72 @@ namespace rvs
 	extern bool g_verbose;
 }
 
+#ifndef _WIN32
+namespace
+{
+	// Client stand-in: request the poses of a pose trace (or the pose of the virtual cameras) and report the round-trip times
+	void runClient(std::string const& socketpath, std::string const& posetrace, bool shutdown)
+	{
+		auto poses = posetrace.empty()
+			? rvs::PoseTrace()
+			: rvs::PoseTrace::loadFromFile(posetrace);
+		if (poses.empty()) {
+			poses.push_back({ cv::Vec3f::all(0.f), cv::Vec3f::all(0.f) });
+		}
+
+		rvs::Client client(socketpath);
+		auto start = std::chrono::steady_clock::now();
+		client.request(poses);
+
+		std::size_t expected = poses.size();
+		for (std::size_t received = 0; received != expected; ++received) {
+			rvs::server::FrameHeader header;
+			auto color = client.receive(header);
+			expected = poses.size() * header.number_of_virtual_views;
+			auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			std::cout << "Pose " << header.pose << ", virtual view " << header.virtual_view << ": "
+				<< color.size() << " after " << std::fixed << std::setprecision(3) << elapsed << " ms" << std::endl;
+		}
+
+		if (shutdown) {
+			client.shutdown();
+		}
+	}
+}
+#endif
+
 int main(int argc, char* argv[])
 {
 	try
 	{
 		rvs::g_verbose = true;
+		bool with_opengl = true;
 		bool with_analyzer = false;
+		bool shutdown = false;
 		std::string filename;
+		std::string serve_socketpath;
+		std::string client_socketpath;
+		std::string shader_cache;
 
 		for (int i = 1; i < argc; ++i) {
 			if (strcmp(argv[i], "--noopengl") == 0) {
-				rvs::g_with_opengl = false;
+				with_opengl = false;
 			}
 			else if (strcmp(argv[i], "--analyzer") == 0) {
 				with_analyzer = true;
 			}
+			else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+				serve_socketpath = argv[++i];
+			}
+			else if (strcmp(argv[i], "--client") == 0 && i + 1 < argc) {
+				client_socketpath = argv[++i];
+			}
+			else if (strcmp(argv[i], "--shadercache") == 0 && i + 1 < argc) {
+				shader_cache = argv[++i];
+			}
+			else if (strcmp(argv[i], "--shutdown") == 0) {
+				shutdown = true;
+			}
 			else if (strcmp(argv[i], "--help") == 0) {
 				filename.clear();
 				break;
@@ -94,6 +150,13 @@ int main(int argc, char* argv[])
 			<< "|    MPEG2018/N18068 Reference View Synthesizer (RVS) manual                               |\n"
 			<< " - -------------------------------------------------------------------------------------- -" << std::endl;
 
+#ifndef _WIN32
+		if (!client_socketpath.empty()) {
+			runClient(client_socketpath, filename, shutdown);
+			return 0;
+		}
+#endif
+
 		if (filename.empty()) {
 			std::cout
 				<< "\n"
@@ -110,27 +173,40 @@ int main(int argc, char* argv[])
 				<< "|      Bart Sonneveldt, bart.sonneveldt@philips.com                                        |\n"
 				<< " - -------------------------------------------------------------------------------------- -\n\n";
 
-			throw std::runtime_error("Usage: RVS CONFIGURATION_FILE [--noopengl] [--analyzer]");
+			throw std::runtime_error(
+				"Usage: RVS CONFIGURATION_FILE [--noopengl] [--shadercache DIR] [--analyzer] [--serve SOCKET]\n"
+				"       RVS --client SOCKET [POSE_TRACE] [--shutdown]");
 		}
 		
 		// Store clock time before application start
 		auto startTime = clock();
 
 #if WITH_OPENGL
-		if (rvs::g_with_opengl) {
+		if (with_opengl) {
 			rvs::opengl::context_init();
+			rvs::opengl::ShadersList::setCacheDirectory(shader_cache);
 		}
 #else
-		rvs::g_with_opengl = false;
+		with_opengl = false;
 #endif
 		
+		if (!serve_socketpath.empty()) {
+#ifndef _WIN32
+			rvs::Server server(filename, serve_socketpath, with_opengl);
+			server.serve();
+			return 0;
+#else
+			throw std::runtime_error("The server (--serve) is not available on Windows");
+#endif
+		}
+
 		std::unique_ptr<rvs::Application> application;
 
 		if (with_analyzer) {
-			application.reset(new rvs::Analyzer(filename));
+			application.reset(new rvs::Analyzer(filename, with_opengl));
 		}
 		else {
-			application.reset(new rvs::Application(filename));
+			application.reset(new rvs::Application(filename, "", with_opengl));
 		}
 
 		application->execute();
@@ -138,10 +214,10 @@ int main(int argc, char* argv[])
 		// Compute execution time
 		auto executeTime = double(clock() - startTime) / CLOCKS_PER_SEC;
     
-		if (rvs::g_with_opengl) {
+		if (with_opengl) {
 			std::cout 
 			<< std::endl 
-			<< "Reported execution time is not accurate as GPU time is missing." 
+			<< "Total time is CPU time: see the timings of each frame for the GPU time per stage." 
 			<< std::endl;
 		}
         